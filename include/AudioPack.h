@@ -0,0 +1,118 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief 预先合成的词表音频包（只读，内存映射）
+ *
+ * 由 tools/audio_pack_builder 生成，文件布局：
+ *
+ *     文件头（32 字节）  magic "WAPK"、版本、条目大小、单词数、采样率、字符串区偏移、音频区偏移
+ *     条目表            每个单词 32 字节：音频偏移、音频长度、单词在字符串区的偏移与长度、保留、音频内容哈希
+ *     字符串区          所有单词依次拼接
+ *     音频区            每个单词一段完整的 WAV（44 字节标准文件头 + 单声道 16 位 PCM），按 8 字节对齐
+ *
+ * 打开时整个文件 mmap 到内存，并为单词建立哈希索引；查找为 O(1)，返回的片段直接
+ * 指向映射内存，发送或播放时无需复制。音频内容哈希在生成时算好，用作 HTTP 的 ETag；
+ * 版本1的条目没有哈希（24 字节），打开时逐段计算一次。
+ */
+class AudioPack {
+public:
+    static constexpr size_t WAV_HEADER_SIZE = 44;   ///< 包内每段 WAV 的文件头长度
+
+    AudioPack() = default;
+
+    /**
+     * @brief 构造并打开音频包（失败时 is_open() 为 false）
+     * @param path 文件路径
+     */
+    explicit AudioPack(const string& path);
+
+    ~AudioPack();
+
+    AudioPack(const AudioPack&) = delete;
+    AudioPack& operator=(const AudioPack&) = delete;
+
+    /**
+     * @brief 映射并校验音频包
+     * @param path 文件路径
+     * @return 是否成功
+     */
+    bool open(const string& path);
+
+    /**
+     * @brief 是否已打开
+     */
+    bool is_open() const;
+
+    /**
+     * @brief 查找单词的音频
+     * @param word 单词
+     * @return 完整的 WAV 内容（指向映射内存），不在包内时为空
+     */
+    string_view find(const string& word) const;
+
+    /**
+     * @brief 查找单词的音频及其内容哈希
+     * @param word 单词
+     * @param hash 输出音频的内容哈希（content_hash 的结果）
+     * @return 完整的 WAV 内容（指向映射内存），不在包内时为空
+     */
+    string_view find(const string& word, uint64_t& hash) const;
+
+    /**
+     * @brief 获取包内单词数
+     */
+    size_t size() const;
+
+    /**
+     * @brief 获取采样率
+     */
+    int sample_rate() const;
+
+    /**
+     * @brief 生成音频包文件内容
+     * @param words 单词
+     * @param clips 与单词一一对应的 WAV（须为 44 字节标准文件头）
+     * @param sample_rate 采样率
+     * @return 文件字节
+     */
+    static string encode(const vector<string>& words, const vector<string>& clips, int sample_rate);
+
+    /**
+     * @brief 计算音频内容的哈希（64 位 FNV-1a）
+     * @param bytes 内容
+     * @return 哈希值
+     */
+    static uint64_t content_hash(string_view bytes);
+
+private:
+    static constexpr char MAGIC[4] = {'W', 'A', 'P', 'K'};
+    static constexpr uint16_t FORMAT_VERSION = 2;
+    static constexpr size_t HEADER_SIZE = 32;
+    static constexpr size_t ENTRY_SIZE = 32;
+    static constexpr size_t V1_ENTRY_SIZE = 24;
+    static constexpr size_t CLIP_ALIGNMENT = 8;
+
+    /**
+     * @brief 索引中的一段音频
+     */
+    struct Clip {
+        string_view wav;    ///< 完整的 WAV（指向映射内存）
+        uint64_t hash;      ///< 内容哈希
+    };
+
+    const char* data = nullptr;                         ///< 映射的文件内容
+    size_t length = 0;                                  ///< 文件长度
+    int rate = 0;                                       ///< 采样率
+    unordered_map<string_view, Clip> clips;             ///< 单词到音频的索引（单词指向映射内存）
+
+    void close();
+};
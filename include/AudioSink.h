@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <sys/types.h>
+
+using namespace std;
+
+/**
+ * @brief 常驻的音频输出
+ *
+ * 第一次播放时启动一个 `aplay` 进程，之后所有 PCM 都写入它的标准输入，
+ * 不再每个单词启动一次播放器。单词间的停顿写入等长的静音，而不是 sleep，
+ * 停顿与朗读严格按音频时间排列。aplay 退出后下一次播放自动重启。
+ */
+class AudioSink {
+public:
+    /**
+     * @brief 构造函数
+     * @param sample_rate 采样率（单声道 16 位）
+     */
+    explicit AudioSink(int sample_rate);
+
+    /**
+     * @brief 析构函数，关闭管道并等待 aplay 播完退出
+     */
+    ~AudioSink();
+
+    AudioSink(const AudioSink&) = delete;
+    AudioSink& operator=(const AudioSink&) = delete;
+
+    /**
+     * @brief 播放 PCM 样本（多个线程同时调用时依次播放，不会交错）
+     * @param samples 样本
+     * @return 是否写入成功
+     */
+    bool play(const vector<int16_t>& samples);
+
+    /**
+     * @brief 播放 PCM 样本（可直接指向音频包的映射内存，不复制）
+     * @param samples 样本首地址
+     * @param count 样本数
+     * @return 是否写入成功
+     */
+    bool play(const int16_t* samples, size_t count);
+
+    /**
+     * @brief 播放静音
+     * @param milliseconds 时长
+     * @return 是否写入成功
+     */
+    bool play_silence(int milliseconds);
+
+private:
+    int sample_rate;        ///< 采样率
+    mutex sink_mutex;       ///< 保护播放器进程与管道
+    pid_t pid = -1;         ///< aplay 进程
+    int fd = -1;            ///< 写入 aplay 标准输入的管道
+
+    /**
+     * @brief 启动 aplay（调用者需持有 sink_mutex）
+     */
+    bool start();
+
+    /**
+     * @brief 关闭管道并等待 aplay 退出（调用者需持有 sink_mutex）
+     */
+    void close_player();
+
+    /**
+     * @brief 写入原始字节，播放器已退出时重启一次
+     */
+    bool write_locked(const char* data, size_t size);
+};
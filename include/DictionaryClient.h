@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+namespace httplib {
+class Client;
+}
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 在线词典的 HTTP 客户端（进程内，带连接池）
+ *
+ * 每条连接是一个开启 keep-alive 的 httplib::Client，用完放回池中，下次查询复用已建立的
+ * TCP/TLS 连接，不再为每次查询启动 curl 进程、重新握手。同一时刻最多打开
+ * max_connections 条连接，全部占用时等待归还。
+ *
+ * 编译时定义 CPPHTTPLIB_OPENSSL_SUPPORT（CMake 找到 OpenSSL 时自动定义）才支持 https；
+ * 否则默认的 https 地址无法连接、查询直接失败，不会自动降级为明文 http，
+ * 只有显式配置的 http 地址可用（例如本地的词典桩服务 tools/dictionary_stub_server）。
+ */
+class DictionaryClient {
+public:
+    /**
+     * @brief 连接配置
+     */
+    struct Options {
+        string base_url;                ///< 词典服务地址（scheme://host[:port]）
+        int connect_timeout_ms = 3000;  ///< 建立连接超时
+        int read_timeout_ms = 5000;     ///< 等待响应超时
+        size_t max_connections = 4;     ///< 连接数上限
+
+        /**
+         * @brief 默认配置（https 地址，与是否支持 OpenSSL 无关）
+         */
+        Options();
+    };
+
+    /**
+     * @brief 构造函数（第一次查询时才建立连接）
+     * @param options 连接配置
+     */
+    explicit DictionaryClient(const Options& options = Options());
+
+    /**
+     * @brief 析构函数，关闭所有连接
+     */
+    ~DictionaryClient();
+
+    DictionaryClient(const DictionaryClient&) = delete;
+    DictionaryClient& operator=(const DictionaryClient&) = delete;
+
+    /**
+     * @brief 发送 GET 请求
+     * @param path 路径与查询参数（查询参数需已编码）
+     * @param body 输出响应体
+     * @param error 输出失败原因
+     * @return 是否收到 2xx 响应
+     */
+    bool get(const string& path, string& body, string& error);
+
+    /**
+     * @brief 获取连接池统计
+     * @return JSON格式的请求数、失败数、连接数、等待次数与平均耗时
+     */
+    json get_stats() const;
+
+    /**
+     * @brief 对查询参数做百分号编码
+     * @param value 原始值（UTF-8）
+     * @return 编码后的值
+     */
+    static string url_encode(const string& value);
+
+private:
+    Options options;                            ///< 连接配置
+
+    mutable mutex pool_mutex;                   ///< 保护以下成员
+    condition_variable released;                ///< 有连接归还时通知
+    vector<unique_ptr<httplib::Client>> idle;   ///< 空闲连接
+    size_t open_connections = 0;                ///< 已创建（空闲 + 使用中）的连接数
+
+    atomic<uint64_t> requests{0};               ///< 请求次数
+    atomic<uint64_t> failures{0};               ///< 失败次数
+    atomic<uint64_t> waits{0};                  ///< 因连接用尽而等待的次数
+    atomic<uint64_t> total_us{0};               ///< 请求总耗时（微秒）
+
+    /**
+     * @brief 取出一条空闲连接，没有时新建，达到上限时等待
+     * @return 连接，等待超时返回空指针
+     */
+    unique_ptr<httplib::Client> acquire();
+
+    /**
+     * @brief 归还连接
+     * @param client 连接
+     */
+    void release(unique_ptr<httplib::Client> client);
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+struct EpochSlot;
+
+/**
+ * @brief 基于纪元（epoch）的延迟回收
+ *
+ * 读者在 Guard 作用域内读取通过原子指针发布的只读对象，进入时只写一次本线程的
+ * 纪元槽，不加锁、不等待。写者替换指针后调用 retire() 交出旧对象，等到所有
+ * 可能还在读旧对象的读者都离开后才真正释放。
+ *
+ * 正确性依赖顺序一致的原子操作：写者先交换指针，再递增全局纪元并以递增前的值
+ * 标记旧对象；读者先公布自己看到的全局纪元，再读取指针。
+ */
+class EpochReclaimer {
+public:
+    /**
+     * @brief 获取进程共享的回收器
+     */
+    static EpochReclaimer& instance();
+
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    /**
+     * @brief 读侧临界区，作用域内读到的已发布对象不会被释放（可嵌套）
+     */
+    class Guard {
+    public:
+        explicit Guard(EpochReclaimer& reclaimer);
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        EpochSlot* slot;
+    };
+
+    /**
+     * @brief 交出已从原子指针上摘下的旧对象，安全后自动 delete
+     * @param object 旧对象
+     */
+    template <typename T>
+    void retire(const T* object) {
+        retire(object, [](const void* pointer) { delete static_cast<const T*>(pointer); });
+    }
+
+    /**
+     * @brief 获取等待回收的对象数
+     */
+    size_t pending() const;
+
+private:
+    /**
+     * @brief 等待回收的对象
+     */
+    struct Retired {
+        uint64_t epoch;                     ///< 交出时的纪元
+        const void* object;                 ///< 对象指针
+        void (*deleter)(const void*);       ///< 释放函数
+    };
+
+    atomic<uint64_t> global_epoch{1};       ///< 全局纪元（0 表示槽空闲）
+    atomic<EpochSlot*> slots{nullptr};    ///< 线程槽链表（只增不删，线程退出后复用）
+    mutable mutex retired_mutex;            ///< 保护 retired（只有写者使用）
+    vector<Retired> retired;                ///< 等待回收的对象
+
+    EpochReclaimer() = default;
+    ~EpochReclaimer();
+
+    /**
+     * @brief 获取当前线程的槽，首次调用时分配或复用空闲槽
+     */
+    EpochSlot* local_slot();
+
+    /**
+     * @brief 交出旧对象并尝试回收
+     */
+    void retire(const void* object, void (*deleter)(const void*));
+
+    /**
+     * @brief 释放所有读者都已离开的对象（调用者需持有 retired_mutex）
+     */
+    void reclaim();
+
+};
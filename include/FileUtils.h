@@ -33,6 +33,18 @@ public:
      */
     static bool write_text_file(const string& filepath, const string& content);
     
+    /**
+     * @brief 原子写入文本文件
+     * 
+     * 先写入同目录下的临时文件，再重命名覆盖目标文件，
+     * 读者要么看到旧内容，要么看到完整的新内容
+     * 
+     * @param filepath 文件路径
+     * @param content 要写入的内容
+     * @return 是否写入成功
+     */
+    static bool write_text_file_atomic(const string& filepath, const string& content);
+    
     /**
      * @brief 获取文件扩展名
      * @param filename 文件名
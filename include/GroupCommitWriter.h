@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief 成组提交的持久化文件写入器
+ *
+ * 每个文件先写入同目录下的临时文件并 fsync，再重命名覆盖目标文件，
+ * 崩溃后读者要么看到旧内容，要么看到完整的新内容。
+ *
+ * 在提交窗口内（以及上一批正在提交期间）到达的写入合并为一批：
+ * 同一路径只写最后一次的内容，重命名后每个目录只 fsync 一次。
+ * 每个调用者只等待自己所在的那一批完成。
+ */
+class GroupCommitWriter {
+public:
+    /**
+     * @brief 获取进程共享的写入器
+     *
+     * 提交窗口由环境变量 GROUP_COMMIT_WINDOW_US 配置（微秒，默认1000）。
+     */
+    static GroupCommitWriter& instance();
+
+    /**
+     * @brief 构造函数
+     * @param window_us 批次的第一个写入者等待其他写入者加入的时间（微秒）
+     */
+    explicit GroupCommitWriter(int window_us = 1000);
+
+    GroupCommitWriter(const GroupCommitWriter&) = delete;
+    GroupCommitWriter& operator=(const GroupCommitWriter&) = delete;
+
+    /**
+     * @brief 持久化地替换文件内容，返回时数据与目录项均已落盘
+     * @param path 目标文件路径
+     * @param content 文件内容
+     * @return 是否写入成功
+     */
+    bool write(const string& path, const string& content);
+
+    /**
+     * @brief 已提交的批次数
+     */
+    uint64_t get_batch_count() const;
+
+    /**
+     * @brief 已写入的文件数
+     */
+    uint64_t get_file_count() const;
+
+private:
+    /**
+     * @brief 一批待提交的写入
+     */
+    struct Batch {
+        map<string, string> files;      ///< 路径到内容（同一路径只保留最后一次）
+        map<string, bool> results;      ///< 各路径的写入结果
+        bool done = false;              ///< 是否已提交
+    };
+
+    int window_us;                      ///< 提交窗口（微秒）
+    mutable mutex batch_mutex;          ///< 保护 open_batch、各批次状态与计数
+    mutex commit_mutex;                 ///< 同一时间只提交一批
+    condition_variable batch_done;      ///< 批次提交完成通知
+    shared_ptr<Batch> open_batch;       ///< 正在接收写入的批次
+    uint64_t batch_count = 0;           ///< 已提交批次数
+    uint64_t file_count = 0;            ///< 已写入文件数
+
+    /**
+     * @brief 写入、重命名并同步一批文件
+     * @param batch 要提交的批次（填写 results）
+     */
+    static void commit(Batch& batch);
+
+    /**
+     * @brief 写入临时文件并 fsync
+     * @param path 临时文件路径
+     * @param content 文件内容
+     * @return 是否成功
+     */
+    static bool write_synced(const string& path, const string& content);
+
+    /**
+     * @brief fsync 目录，使其中的重命名落盘
+     * @param directory 目录路径
+     * @return 是否成功
+     */
+    static bool sync_directory(const string& directory);
+};
@@ -2,7 +2,13 @@
 
 #include <httplib.h>
 #include <memory>
+#include <atomic>
 #include "WordApp.h"
+#include "ServerConfig.h"
+#include "WorkStealingTaskQueue.h"
+#include "AudioPack.h"
+#include "SpeechJobQueue.h"
+#include "WordAudio.h"
 
 /**
  * @brief HTTP服务器类
@@ -13,6 +19,11 @@ class HttpServer {
 private:
     httplib::Server server;           ///< HTTP服务器实例
     std::shared_ptr<WordApp> app;     ///< 单词应用实例
+    ServerConfig config;              ///< 部署配置
+    std::atomic<WorkStealingTaskQueue*> task_queue{nullptr}; ///< 监听期间的任务队列（由 httplib 持有并释放）
+    AudioPack audio_pack;             ///< 预先合成的词表音频（须先于朗读队列构造）
+    SpeechJobQueue speech_jobs;       ///< 朗读任务队列
+    WordAudio word_audio;             ///< 下发给浏览器的单词音频
     
     /**
      * @brief 设置CORS头部
@@ -29,6 +40,11 @@ private:
      */
     void setup_api_routes();
     
+    /**
+     * @brief 设置调试路由（只在配置 debug_routes 开启时调用，这些路由不要求登录）
+     */
+    void setup_debug_routes();
+    
     /**
      * @brief 获取文件的MIME类型
      * @param filename 文件名
@@ -36,20 +52,84 @@ private:
      */
     string get_content_type(const string& filename);
 
+    /**
+     * @brief 从请求中取出会话令牌
+     *
+     * 优先使用 X-Session-Token 头（脚本客户端），否则读取 session_token Cookie（浏览器）。
+     *
+     * @param req HTTP请求
+     * @return 会话令牌，没有则返回空字符串
+     */
+    static string get_session_token(const httplib::Request& req);
+
+    /**
+     * @brief 设置会话 Cookie
+     * @param res HTTP响应
+     * @param token 会话令牌，为空时清除 Cookie
+     */
+    static void set_session_cookie(httplib::Response& res, const string& token);
+
+    /**
+     * @brief 获取调用者的用户上下文
+     *
+     * 未登录时写入错误响应并返回空指针，处理函数直接返回即可。
+     *
+     * @param req HTTP请求
+     * @param res HTTP响应
+     * @return 用户上下文
+     */
+    shared_ptr<UserContext> require_user(const httplib::Request& req, httplib::Response& res);
+
+    /**
+     * @brief 发送长度已知的音频（强 ETag、永久缓存、支持 Range）
+     *
+     * If-None-Match 与 ETag 相同时返回 304；Range 请求由 httplib 按偏移调用内容提供函数，
+     * 只输出所需的片段。
+     *
+     * @param req HTTP请求
+     * @param res HTTP响应
+     * @param body 音频内容
+     */
+    static void send_audio(const httplib::Request& req, httplib::Response& res, WordAudio::Body body);
+
+    /**
+     * @brief 发送单词序列：音频都已存在时按长度已知发送，否则边合成边输出
+     * @param req HTTP请求
+     * @param res HTTP响应
+     * @param words 单词
+     * @param pause_ms 单词间停顿（毫秒）
+     */
+    void send_sequence(const httplib::Request& req, httplib::Response& res, vector<string> words, int pause_ms);
+
+    /**
+     * @brief 边合成边输出单词序列（分块传输，WAV 长度为占位值，合成与发送流水线并行）
+     * @param res HTTP响应
+     * @param words 单词
+     * @param pause_ms 单词间停顿（毫秒）
+     */
+    void stream_audio(httplib::Response& res, vector<string> words, int pause_ms);
+
+    /**
+     * @brief 校验单词列表，不合法时写入 400 响应
+     * @param words 单词
+     * @param res HTTP响应
+     * @return 是否合法
+     */
+    static bool check_audio_words(const vector<string>& words, httplib::Response& res);
+
 public:
     /**
      * @brief 构造函数
      * @param word_app 单词应用实例
+     * @param config 部署配置（监听地址与请求线程池）
      */
-    explicit HttpServer(std::shared_ptr<WordApp> word_app);
+    HttpServer(std::shared_ptr<WordApp> word_app, const ServerConfig& config = ServerConfig());
     
     /**
-     * @brief 启动服务器
-     * @param host 绑定的主机地址
-     * @param port 监听端口
+     * @brief 按配置的地址和端口启动服务器（阻塞直到 stop）
      * @return 是否启动成功
      */
-    bool start(const string& host = "0.0.0.0", int port = 8080);
+    bool start();
     
     /**
      * @brief 停止服务器
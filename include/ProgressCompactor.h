@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+#include "UserProgressLog.h"
+#include "UserProgressFile.h"
+
+using namespace std;
+
+/**
+ * @brief 用户进度日志的后台压缩器
+ *
+ * 后台线程定期扫描用户目录，当某个用户的日志超过大小上限或积压时间上限时，
+ * 将日志合并进新的 <name>.dat 快照（临时文件 + 重命名，原子替换），
+ * 从而保证 set_current_user 时需要重放的日志长度有界。
+ *
+ * 压缩只在轮转日志的一瞬间持有日志锁，合并与写快照期间正在进行的请求
+ * 继续向新日志追加，不会被阻塞。
+ */
+class ProgressCompactor {
+private:
+    string USERS_DIR;                   ///< 用户数据目录
+    UserProgressLog progress_log;       ///< 用户进度日志
+    const UserProgressFile& progress_file; ///< 快照读写
+    uintmax_t max_log_bytes;            ///< 日志大小上限（字节）
+    int max_log_age;                    ///< 日志积压时间上限（秒）
+    int scan_interval;                  ///< 扫描间隔（秒）
+
+    thread worker;                      ///< 后台线程
+    mutex state_mutex;                  ///< 保护以下状态
+    condition_variable wakeup;          ///< 唤醒后台线程
+    bool stopping;                      ///< 是否正在停止
+    set<string> requested;              ///< 请求立即压缩的用户
+    map<string, time_t> dirty_since;    ///< 用户日志首次被发现非空的时间
+
+    /**
+     * @brief 后台线程主循环
+     */
+    void run();
+
+    /**
+     * @brief 扫描用户目录，压缩超过阈值的日志
+     */
+    void scan();
+
+public:
+    /**
+     * @brief 构造函数
+     * @param users_dir 用户数据目录
+     * @param progress_file 快照读写（生命周期需长于压缩器）
+     * @param max_log_bytes 日志大小上限（字节）
+     * @param max_log_age 日志积压时间上限（秒）
+     * @param scan_interval 扫描间隔（秒）
+     */
+    ProgressCompactor(const string& users_dir, const UserProgressFile& progress_file,
+                      uintmax_t max_log_bytes = 64 * 1024, int max_log_age = 300,
+                      int scan_interval = 5);
+
+    /**
+     * @brief 析构函数，停止后台线程
+     */
+    ~ProgressCompactor();
+
+    /**
+     * @brief 启动后台线程
+     */
+    void start();
+
+    /**
+     * @brief 停止后台线程
+     */
+    void stop();
+
+    /**
+     * @brief 请求尽快压缩某个用户的日志
+     * @param username 用户名
+     */
+    void request(const string& username);
+
+    /**
+     * @brief 取消某个用户尚未开始的压缩（删除用户时调用）
+     * @param username 用户名
+     */
+    void cancel(const string& username);
+
+    /**
+     * @brief 立即压缩某个用户的日志（同步）
+     * @param username 用户名
+     * @return 压缩是否成功（没有日志也视为成功）
+     */
+    bool compact(const string& username);
+
+    /**
+     * @brief 获取日志大小上限
+     * @return 字节数
+     */
+    uintmax_t get_max_log_bytes() const;
+};
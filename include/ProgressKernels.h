@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief 进度数组的聚合结果
+ */
+struct ProgressTotals {
+    uint64_t review_count = 0;      ///< 错误次数大于0的单词数
+    uint64_t total_mistakes = 0;    ///< 错误次数总和
+    uint64_t total_correct = 0;     ///< 正确次数总和
+
+    bool operator==(const ProgressTotals& other) const {
+        return review_count == other.review_count &&
+               total_mistakes == other.total_mistakes &&
+               total_correct == other.total_correct;
+    }
+};
+
+/**
+ * @brief 进度数组的聚合计算内核
+ *
+ * 一次遍历 mistakes[] 与 correct[]，同时得到复习单词数、错误总数和正确总数。
+ * 在 x86 上提供 SSE2 与 AVX2 实现，首次调用时按 CPU 支持情况选择，
+ * 其他平台使用标量实现。各实现的结果完全一致。
+ * 设置环境变量 PROGRESS_KERNELS_SCALAR 可强制使用标量实现（便于排查问题）。
+ */
+class ProgressKernels {
+public:
+    /**
+     * @brief 聚合函数类型
+     */
+    using AggregateFunction = ProgressTotals (*)(const uint16_t* mistakes, const uint16_t* correct,
+                                                 size_t count);
+
+    /**
+     * @brief 使用当前 CPU 上最快的实现进行聚合
+     * @param mistakes 错误次数数组
+     * @param correct 正确次数数组
+     * @param count 数组长度
+     * @return 聚合结果
+     */
+    static ProgressTotals aggregate(const uint16_t* mistakes, const uint16_t* correct, size_t count);
+
+    /**
+     * @brief 标量实现
+     */
+    static ProgressTotals aggregate_scalar(const uint16_t* mistakes, const uint16_t* correct,
+                                           size_t count);
+
+    /**
+     * @brief SSE2 实现（非 x86 平台退化为标量实现）
+     */
+    static ProgressTotals aggregate_sse2(const uint16_t* mistakes, const uint16_t* correct,
+                                         size_t count);
+
+    /**
+     * @brief AVX2 实现（非 x86 平台退化为标量实现，调用前需确认 CPU 支持）
+     */
+    static ProgressTotals aggregate_avx2(const uint16_t* mistakes, const uint16_t* correct,
+                                         size_t count);
+
+    /**
+     * @brief 检查当前 CPU 是否支持 SSE2
+     */
+    static bool has_sse2();
+
+    /**
+     * @brief 检查当前 CPU 是否支持 AVX2
+     */
+    static bool has_avx2();
+
+    /**
+     * @brief 获取 aggregate() 实际使用的实现名称
+     * @return "avx2"、"sse2" 或 "scalar"
+     */
+    static const char* implementation();
+
+private:
+    /**
+     * @brief 按 CPU 支持情况选择实现（只执行一次）
+     * @return 选中的实现
+     */
+    static AggregateFunction select();
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "UserProgress.h"
+
+using namespace std;
+
+/**
+ * @brief 快照中的一个复习单词
+ */
+struct ReviewEntry {
+    uint32_t id;                ///< 单词 id
+    uint16_t mistakes;          ///< 错误次数
+    uint16_t correct_count;     ///< 正确次数
+    uint32_t last_seen;         ///< 最后见到时间
+};
+
+/**
+ * @brief 某一时刻用户进度的只读版本
+ *
+ * 写者在独占锁内修改 UserProgress 后生成新版本，通过原子指针整体替换；
+ * 读者在 EpochReclaimer::Guard 内读取当前版本，不加用户锁，也不会被正在
+ * 执行的大批量更新阻塞。发布后不再修改，旧版本由 EpochReclaimer 延迟释放。
+ *
+ * 唯一的例外是复习列表：单词变化后发布的版本不带列表，由第一个需要它的读者
+ * 在用户共享锁内按当时的进度生成并填入，之后的读者直接共享。连续的更新因此
+ * 不会每次都复制整个列表。
+ */
+struct ProgressSnapshot {
+    uint64_t version = 0;                           ///< 版本号，每次发布加1
+    ProgressTotals totals;                          ///< 统计计数
+    int learn_position = 0;                         ///< 学习位置
+    int review_position = 0;                        ///< 复习位置
+
+    /**
+     * @brief 获取复习列表
+     * @return 按复习索引顺序排列的列表，尚未生成时为空
+     */
+    shared_ptr<const vector<ReviewEntry>> get_review_words() const {
+        return atomic_load(&review_words);
+    }
+
+    /**
+     * @brief 填入复习列表（已有列表时保留原列表）
+     * @param words 新生成的列表
+     * @return 本版本最终使用的列表
+     */
+    shared_ptr<const vector<ReviewEntry>> set_review_words(shared_ptr<const vector<ReviewEntry>> words) const {
+        shared_ptr<const vector<ReviewEntry>> expected;
+        if (atomic_compare_exchange_strong(&review_words, &expected, words)) {
+            return words;
+        }
+        return expected;
+    }
+
+    /**
+     * @brief 估算占用的内存
+     * @return 字节数
+     */
+    size_t memory_usage() const {
+        shared_ptr<const vector<ReviewEntry>> words = get_review_words();
+        return sizeof(ProgressSnapshot) + (words ? words->capacity() * sizeof(ReviewEntry) : 0);
+    }
+
+private:
+    mutable shared_ptr<const vector<ReviewEntry>> review_words; ///< 单词未变时与上一版本共享，只通过原子操作访问
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief 复习单词的有序索引（可按名次访问的跳表）
+ *
+ * 只包含错误次数大于0的单词，按 (错误次数降序, 最后见到时间升序, 单词字母序)
+ * 排列。每层指针记录跨越的节点数，因此可以在 O(log n) 内定位第 k 个单词，
+ * 分页读取为 O(log n + 页大小)。单词计数变化时由 UserProgress 调用
+ * update() 维护，不需要每次请求重新扫描排序。
+ */
+class ReviewIndex {
+public:
+    /**
+     * @brief 构造空索引
+     * @param word_ranks 单词 id 到字母序名次的映射（用于最后一级排序），需比索引存活更久
+     */
+    explicit ReviewIndex(const vector<uint32_t>* word_ranks = nullptr);
+
+    ReviewIndex(ReviewIndex&&) = default;
+    ReviewIndex& operator=(ReviewIndex&&) = default;
+    ReviewIndex(const ReviewIndex&) = delete;
+    ReviewIndex& operator=(const ReviewIndex&) = delete;
+
+    /**
+     * @brief 单词计数变化后更新索引
+     * @param id 单词 id
+     * @param mistakes 新的错误次数（为0时从索引移除）
+     * @param last_seen 新的最后见到时间
+     */
+    void update(uint32_t id, uint16_t mistakes, uint32_t last_seen);
+
+    /**
+     * @brief 清空索引
+     */
+    void clear();
+
+    /**
+     * @brief 获取索引中的单词数
+     * @return 复习单词数
+     */
+    size_t size() const;
+
+    /**
+     * @brief 估算索引占用的内存（O(1)）
+     * @return 字节数
+     */
+    size_t memory_usage() const;
+
+    /**
+     * @brief 读取一段连续的单词
+     * @param start 起始名次（从0开始）
+     * @param count 最多读取的数量
+     * @return 按索引顺序排列的单词 id
+     */
+    vector<uint32_t> range(size_t start, size_t count) const;
+
+    /**
+     * @brief 按索引顺序遍历全部单词
+     * @param visit 回调，参数为单词 id
+     */
+    template <typename Visitor>
+    void for_each(Visitor visit) const {
+        for (const Node* node = head->levels[0].next; node; node = node->levels[0].next) {
+            visit(node->key.id);
+        }
+    }
+
+private:
+    static constexpr int MAX_LEVEL = 24;   ///< 最大层数
+
+    /**
+     * @brief 排序键
+     */
+    struct Key {
+        uint16_t mistakes = 0;
+        uint32_t last_seen = 0;
+        uint32_t rank = 0;      ///< 单词字母序名次
+        uint32_t id = 0;
+    };
+
+    struct Node;
+
+    /**
+     * @brief 某一层的前向指针
+     */
+    struct Level {
+        Node* next = nullptr;   ///< 下一个节点
+        size_t span = 0;        ///< 到下一个节点跨越的节点数
+    };
+
+    struct Node {
+        Key key;
+        vector<Level> levels;
+    };
+
+    const vector<uint32_t>* word_ranks;     ///< 单词字母序名次
+    unique_ptr<Node> head;                  ///< 头节点（不存数据）
+    vector<unique_ptr<Node>> nodes;         ///< 按单词 id 存放的节点，不在索引中为空
+    int level = 1;                          ///< 当前层数
+    size_t length = 0;                      ///< 节点数
+    size_t level_count = 0;                 ///< 所有节点的层数之和（用于估算内存）
+    mt19937 generator;                      ///< 层数随机数
+
+    static bool less(const Key& a, const Key& b);
+    int random_level();
+    void insert(unique_ptr<Node> node);
+    unique_ptr<Node> erase(uint32_t id);
+    const Node* node_at(size_t rank) const;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief HTTP 服务器的部署配置
+ *
+ * 先取默认值，再读取 --config 指定的 JSON 文件，最后由命令行参数覆盖。
+ * 配置文件的键与命令行参数同名（去掉前缀并把 - 换成 _），例如：
+ *
+ *     {"host": "127.0.0.1", "port": 8080, "threads": 16, "max_queue": 512, "spare_threads": 4,
+ *      "tts_workers": 2, "tts_queue": 32, "audio_pack": "data/words.pack", "debug_routes": false}
+ */
+struct ServerConfig {
+    static constexpr size_t MAX_THREADS = 1024;     ///< 工作线程与备用线程数的上限
+    static constexpr size_t MAX_TTS_WORKERS = 64;   ///< 朗读线程数的上限
+    static constexpr size_t MAX_DICTIONARY_CONNECTIONS = 256; ///< 在线词典连接数的上限
+
+    string host = "0.0.0.0";    ///< 绑定地址
+    int port = 8080;            ///< 监听端口
+    size_t threads;             ///< 处理请求的工作线程数
+    size_t max_queue = 256;     ///< 等待处理的连接上限，超出后拒绝新连接
+    size_t spare_threads = 4;   ///< 慢处理（词典查询）占用工作线程时可临时补上的线程数
+    size_t tts_workers = 2;     ///< 朗读线程数（同时播放的单词数）
+    size_t tts_queue = 32;      ///< 排队中的朗读任务上限，超出后 /speak 返回 503
+    string audio_pack = "data/words.pack"; ///< 预先合成的音频包（不存在时全部现场合成）
+    string reader_socket;       ///< word_reader 守护进程的套接字（设置后 /speak 转发给它朗读）
+    string dictionary_url;      ///< 在线词典地址（为空时使用 DictionaryClient 的默认地址）
+    int dictionary_connect_timeout_ms = 3000;   ///< 在线词典建立连接超时
+    int dictionary_read_timeout_ms = 5000;      ///< 在线词典响应超时
+    size_t dictionary_connections = 4;          ///< 在线词典的连接数上限
+    bool debug_routes = false;  ///< 是否注册 /debug/* 路由（会暴露所有用户的缓存与锁统计，默认关闭）
+    bool help = false;          ///< 是否只打印用法
+
+    /**
+     * @brief 构造默认配置（工作线程数与 httplib 默认线程池相同）
+     */
+    ServerConfig();
+
+    /**
+     * @brief 读取 JSON 配置文件，文件中没有的键保持原值
+     * @param path 文件路径
+     * @return 是否读取成功
+     */
+    bool load_file(const string& path);
+
+    /**
+     * @brief 解析命令行参数（--config 先于其他参数生效）
+     * @param argc 参数个数
+     * @param argv 参数数组
+     * @return 是否解析成功
+     */
+    bool parse_args(int argc, char* argv[]);
+
+    /**
+     * @brief 检查数值配置的范围
+     * @return 错误说明，全部有效时为空
+     */
+    string validate() const;
+
+    /**
+     * @brief 获取用法说明
+     * @param program 程序名
+     * @return 用法文本
+     */
+    static string usage(const string& program);
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <future>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 按用户分片的单线程执行器（actor 模式）
+ *
+ * 每个分片一个工作线程和一个无锁多生产者单消费者队列。同一用户的所有操作
+ * 都投递到同一个分片、在同一个线程上依次执行，因此操作用户状态时不需要加锁；
+ * 请求线程投递后等待结果。工作线程每次醒来会连续执行队列中的全部任务，
+ * 同一用户的一串突发更新自然成批处理。
+ */
+class ShardExecutor {
+public:
+    /**
+     * @brief 构造函数，启动全部工作线程
+     * @param shard_count 分片数（通常等于核数）
+     */
+    explicit ShardExecutor(size_t shard_count);
+
+    /**
+     * @brief 析构函数，执行完已投递的任务后停止工作线程
+     */
+    ~ShardExecutor();
+
+    ShardExecutor(const ShardExecutor&) = delete;
+    ShardExecutor& operator=(const ShardExecutor&) = delete;
+
+    /**
+     * @brief 在键所在分片的线程上执行任务并等待结果
+     *
+     * 任务抛出的异常在调用者线程重新抛出。已在该分片线程上调用时直接执行。
+     *
+     * @param key 分片键（用户名）
+     * @param task 任务
+     * @return 任务的返回值
+     */
+    template <typename Task>
+    auto run(const string& key, Task task) -> decltype(task()) {
+        using Result = decltype(task());
+        Shard& shard = shards[shard_of(key)];
+        if (current_shard == &shard || stopped.load()) {
+            return task();
+        }
+
+        promise<Result> result;
+        future<Result> done = result.get_future();
+        post(shard, [&task, &result] {
+            try {
+                if constexpr (is_void_v<Result>) {
+                    task();
+                    result.set_value();
+                } else {
+                    result.set_value(task());
+                }
+            } catch (...) {
+                result.set_exception(current_exception());
+            }
+        });
+        return done.get();
+    }
+
+    /**
+     * @brief 计算键所在的分片
+     * @param key 分片键
+     * @return 分片下标
+     */
+    size_t shard_of(const string& key) const;
+
+    /**
+     * @brief 获取分片数
+     */
+    size_t shard_count() const;
+
+    /**
+     * @brief 执行完已投递的任务后停止工作线程（可重复调用）
+     */
+    void stop();
+
+    /**
+     * @brief 获取各分片的任务数、批次数与最大队列深度
+     * @return JSON格式的统计
+     */
+    json get_stats() const;
+
+private:
+    /**
+     * @brief 队列节点
+     */
+    struct Node {
+        atomic<Node*> next{nullptr};    ///< 下一个节点
+        function<void()> task;          ///< 任务
+    };
+
+    /**
+     * @brief 一个执行分片，按缓存行对齐避免伪共享
+     *
+     * 队列为带哨兵节点的侵入式 MPSC 队列：生产者交换 head 后链接前驱，
+     * 只有工作线程移动 tail。
+     */
+    struct alignas(64) Shard {
+        atomic<Node*> head;                 ///< 最后入队的节点（生产者端）
+        Node* tail;                         ///< 哨兵节点（消费者端）
+        atomic<bool> sleeping{false};       ///< 工作线程是否准备休眠
+        mutex wakeup_mutex;                 ///< 休眠与唤醒
+        condition_variable wakeup;          ///< 有新任务或停止时通知
+        thread worker;                      ///< 工作线程
+        atomic<int64_t> depth{0};           ///< 队列中的任务数
+        atomic<int64_t> max_depth{0};       ///< 最大队列深度
+        atomic<uint64_t> tasks{0};          ///< 已执行的任务数
+        atomic<uint64_t> bursts{0};         ///< 醒来后连续执行的批次数
+
+        Shard();
+        ~Shard();
+    };
+
+    size_t count;                   ///< 分片数
+    unique_ptr<Shard[]> shards;     ///< 分片数组
+    atomic<bool> stopping{false};   ///< 是否正在停止
+    atomic<bool> stopped{false};    ///< 工作线程是否已全部退出
+
+    inline static thread_local const Shard* current_shard = nullptr;   ///< 当前线程所属的分片
+
+    /**
+     * @brief 把任务放入分片队列，工作线程休眠时唤醒它
+     */
+    void post(Shard& shard, function<void()> task);
+
+    /**
+     * @brief 取出一个任务（只由工作线程调用）
+     * @return 是否取到
+     */
+    static bool pop(Shard& shard, function<void()>& task);
+
+    /**
+     * @brief 工作线程主循环
+     */
+    void run_shard(Shard& shard);
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief 语音合成引擎（进程内共享一个）
+ *
+ * 编译时定义 WORD_APP_HAVE_ESPEAK_NG（CMake 找到 libespeak-ng 时自动定义）则直接
+ * 调用 espeak-ng 库，引擎只初始化一次，PCM 通过回调写入内存，不创建进程。
+ * 否则回退为启动 `espeak --stdout`，从管道读出 WAV 后解码到内存，仍然不经过
+ * shell，也不直接播放。
+ *
+ * 输出均为单声道 16 位 PCM，采样率见 sample_rate()。
+ */
+class SpeechEngine {
+public:
+    /**
+     * @brief 获取进程共享的引擎（espeak-ng 的状态是全局的）
+     */
+    static SpeechEngine& instance();
+
+    SpeechEngine(const SpeechEngine&) = delete;
+    SpeechEngine& operator=(const SpeechEngine&) = delete;
+
+    /**
+     * @brief 是否可以合成（库初始化成功或找到 espeak 程序）
+     */
+    bool available() const;
+
+    /**
+     * @brief 获取使用的后端名称
+     * @return "libespeak-ng"、"espeak --stdout" 或 "none"
+     */
+    string backend() const;
+
+    /**
+     * @brief 获取输出采样率
+     */
+    int sample_rate() const;
+
+    /**
+     * @brief 合成一段文本
+     * @param text 文本（UTF-8）
+     * @param speed 语速（每分钟单词数）
+     * @param samples 输出 PCM 样本（追加到末尾）
+     * @return 是否成功
+     */
+    bool synthesize(const string& text, int speed, vector<int16_t>& samples);
+
+    /**
+     * @brief 把 PCM 样本封装为 WAV 文件内容
+     * @param samples 单声道 16 位样本
+     * @param sample_rate 采样率
+     * @return WAV 字节
+     */
+    static string encode_wav(const vector<int16_t>& samples, int sample_rate);
+
+    /**
+     * @brief 生成 44 字节的 WAV 文件头
+     * @param data_size PCM 字节数（边合成边输出时传 STREAMING_SIZE）
+     * @param sample_rate 采样率
+     * @return 文件头字节
+     */
+    static string wav_header(uint32_t data_size, int sample_rate);
+
+    static constexpr uint32_t STREAMING_SIZE = 0x7ffff000;  ///< 长度未知时的占位值（与 espeak --stdout 相同）
+
+    /**
+     * @brief 解析单声道 16 位 WAV
+     *
+     * 流式输出的 WAV 头里长度可能是占位值，按实际剩余字节读取。
+     *
+     * @param wav WAV 字节
+     * @param samples 输出样本（追加到末尾）
+     * @param sample_rate 输出采样率
+     * @return 是否为支持的格式
+     */
+    static bool decode_wav(const string& wav, vector<int16_t>& samples, int& sample_rate);
+
+private:
+    mutex synth_mutex;          ///< espeak-ng 库不可重入，合成需串行
+    bool library_ready = false; ///< 库是否初始化成功
+    string espeak_program;      ///< 回退使用的 espeak 程序路径
+    int rate = 22050;           ///< 输出采样率
+
+    SpeechEngine();
+    ~SpeechEngine();
+
+    /**
+     * @brief 启动 espeak --stdout 合成（回退路径）
+     */
+    bool synthesize_with_program(const string& text, int speed, vector<int16_t>& samples) const;
+};
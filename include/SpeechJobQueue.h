@@ -0,0 +1,133 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include "SpeechEngine.h"
+#include "AudioSink.h"
+#include "AudioPack.h"
+#include "WordReaderClient.h"
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 朗读任务队列
+ *
+ * /speak 只把单词放入有界队列并立即返回任务编号，由固定数量的朗读线程播放：
+ * 单词在预先合成的音频包中时直接播放映射内存中的 PCM，否则用进程内的 SpeechEngine
+ * 现场合成，再写入常驻的 AudioSink（多个线程同时完成时依次播放）。
+ * 配置了 word_reader 守护进程时改为把单词转发给它朗读，守护进程不可用时回退到本地播放。
+ * HTTP 线程不等待音频，连续点击也只会排队或被拒绝，不会占满请求线程。
+ */
+class SpeechJobQueue {
+public:
+    /**
+     * @brief 任务状态
+     */
+    enum class State { QUEUED, RUNNING, DONE, FAILED };
+
+    /**
+     * @brief 构造函数，启动朗读线程
+     * @param worker_count 朗读线程数
+     * @param max_pending 排队任务上限
+     * @param pack 预先合成的音频包（可为空，需比队列存活更久）
+     * @param reader_socket word_reader 守护进程的套接字路径（为空时不使用）
+     * @param speed 语速（每分钟单词数）
+     */
+    SpeechJobQueue(size_t worker_count, size_t max_pending, const AudioPack* pack = nullptr,
+                   const string& reader_socket = "", int speed = 150);
+
+    /**
+     * @brief 析构函数，丢弃排队中的任务，等待正在朗读的任务结束
+     */
+    ~SpeechJobQueue();
+
+    SpeechJobQueue(const SpeechJobQueue&) = delete;
+    SpeechJobQueue& operator=(const SpeechJobQueue&) = delete;
+
+    /**
+     * @brief 提交朗读任务
+     * @param word 要朗读的文本
+     * @return 任务编号，队列已满时返回0
+     */
+    uint64_t submit(const string& word);
+
+    /**
+     * @brief 查询任务状态
+     * @param id 任务编号
+     * @param status 输出任务信息
+     * @return 任务是否存在（完成较早的任务会被清理）
+     */
+    bool get_status(uint64_t id, json& status) const;
+
+    /**
+     * @brief 获取队列统计
+     * @return JSON格式的排队数、执行中数量与完成、失败、拒绝、音频包命中次数
+     */
+    json get_stats() const;
+
+private:
+    /**
+     * @brief 一个朗读任务
+     */
+    struct Job {
+        string word;                                ///< 朗读文本
+        State state = State::QUEUED;                ///< 状态
+        string error;                               ///< 失败原因
+        size_t audio_ms = 0;                        ///< 合成音频的时长
+        chrono::steady_clock::time_point created;   ///< 提交时间
+        chrono::steady_clock::time_point started;   ///< 开始时间
+        chrono::steady_clock::time_point finished;  ///< 结束时间
+    };
+
+    static constexpr size_t MAX_FINISHED = 256;     ///< 保留的已结束任务数
+
+    SpeechEngine& engine;               ///< 语音合成引擎
+    const AudioPack* pack;              ///< 预先合成的音频包（可为空）
+    AudioSink sink;                     ///< 音频输出
+    unique_ptr<WordReaderClient> reader;    ///< word_reader 守护进程（可为空）
+    size_t max_pending;                 ///< 排队上限
+    int speed;                          ///< 语速
+    vector<thread> workers;             ///< 朗读线程
+
+    mutable mutex jobs_mutex;           ///< 保护以下成员
+    condition_variable job_ready;       ///< 有新任务或停止时通知
+    map<uint64_t, Job> jobs;            ///< 按编号保存的任务
+    deque<uint64_t> pending;            ///< 排队中的任务编号
+    deque<uint64_t> finished;           ///< 已结束的任务编号（按结束顺序，用于清理）
+    uint64_t next_id = 1;               ///< 下一个任务编号
+    size_t running = 0;                 ///< 执行中的任务数
+    uint64_t completed_count = 0;       ///< 成功次数
+    uint64_t failed_count = 0;          ///< 失败次数
+    uint64_t rejected_count = 0;        ///< 因队列满拒绝的次数
+    atomic<uint64_t> pack_hits{0};      ///< 直接使用音频包的次数
+    atomic<uint64_t> forwarded{0};      ///< 转发给守护进程的次数
+    bool stopping = false;              ///< 是否正在停止
+
+    /**
+     * @brief 朗读线程主循环
+     */
+    void run_worker();
+
+    /**
+     * @brief 合成并播放
+     * @param word 朗读文本
+     * @param job_error 输出失败原因
+     * @param audio_ms 输出音频时长
+     * @return 是否成功
+     */
+    bool speak(const string& word, string& job_error, size_t& audio_ms);
+
+    static const char* state_name(State state);
+};
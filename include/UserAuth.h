@@ -3,7 +3,15 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <functional>
+#include <atomic>
+#include <ctime>
 #include <nlohmann/json.hpp>
+#include "VocabularyCatalog.h"
+#include "UserProgressFile.h"
 
 using json = nlohmann::json;
 using namespace std;
@@ -11,21 +19,33 @@ using namespace std;
 /**
  * @brief 用户认证和会话管理类
  * 
- * 负责用户登录、会话管理、用户数据存储等认证相关功能
+ * 负责用户登录、会话管理、用户数据存储等认证相关功能。
+ * 登录返回随机会话令牌，之后每个请求凭令牌找到自己的用户，
+ * 同一实例可以同时服务多个已登录用户。
  */
 class UserAuth {
 private:
     string USERS_DIR;           ///< 用户数据目录
-    string WORDS_FILE;          ///< 单词模板文件路径
-    string current_user;        ///< 当前登录用户
-    map<string, json> active_sessions; ///< 活跃用户会话
+    const VocabularyCatalog& catalog; ///< 共享词表
 
     /**
-     * @brief 获取用户数据文件路径
-     * @param username 用户名
-     * @return 用户数据文件完整路径
+     * @brief 一个登录会话
      */
-    string get_user_data_file(const string& username);
+    struct Session {
+        string username;                ///< 用户名
+        time_t login_time;              ///< 登录时间
+        mutable atomic<time_t> last_seen; ///< 最近一次使用的时间（查找令牌时在共享锁下更新）
+
+        Session(const string& username, time_t now) : username(username), login_time(now), last_seen(now) {}
+    };
+
+    map<string, Session> active_sessions; ///< 会话令牌到会话信息
+    mutable shared_mutex sessions_mutex; ///< 保护 active_sessions（查找令牌只需共享锁）
+    time_t session_idle_seconds;       ///< 会话闲置超过该时间后失效（环境变量 SESSION_IDLE_SECONDS，默认 7 天）
+    time_t last_sweep = 0;             ///< 上次清理过期会话的时间（在 sessions_mutex 独占锁下读写）
+    mutex account_registry_mutex;      ///< 保护 account_locks
+    map<string, unique_ptr<mutex>> account_locks; ///< 按用户名串行化创建、登录与删除
+    unique_ptr<UserProgressFile> progress_file; ///< 用户快照读写
 
     /**
      * @brief 检查用户是否存在
@@ -34,6 +54,13 @@ private:
      */
     bool user_exists(const string& username);
 
+    /**
+     * @brief 获取用户名对应的账户锁
+     * @param username 用户名
+     * @return 该用户名的互斥锁（持有期间同名用户的登录与删除互斥）
+     */
+    mutex& account_mutex(const string& username);
+
     /**
      * @brief 为新用户创建数据文件
      * @param username 用户名
@@ -48,6 +75,36 @@ private:
      */
     bool is_valid_username(const string& username);
 
+    /**
+     * @brief 生成随机会话令牌
+     * @return 32位十六进制字符串
+     */
+    static string generate_token();
+
+    /**
+     * @brief 会话是否已闲置过期
+     * @param session 会话
+     * @param now 当前时间
+     * @return 是否过期
+     */
+    bool is_expired(const Session& session, time_t now) const;
+
+    /**
+     * @brief 清理过期会话（调用者需持有 sessions_mutex 独占锁）
+     *
+     * 登录时调用，距上次清理不足闲置时限的十分之一时跳过，不会每次登录都扫描全部会话。
+     *
+     * @param now 当前时间
+     */
+    void sweep_expired_sessions(time_t now);
+
+    /**
+     * @brief 结束某个用户的全部会话
+     * @param username 用户名
+     * @return 结束的会话数
+     */
+    size_t revoke_sessions(const string& username);
+
 public:
     /**
      * @brief 构造函数，初始化用户认证系统
@@ -60,9 +117,9 @@ public:
     ~UserAuth();
 
     /**
-     * @brief 用户登录
+     * @brief 用户登录，创建新会话
      * @param username 用户名
-     * @return JSON格式的登录结果
+     * @return JSON格式的登录结果（成功时包含 session_token）
      */
     json login(const string& username);
 
@@ -74,53 +131,70 @@ public:
     json register_user(const string& username);
 
     /**
-     * @brief 获取当前登录用户
-     * @return 当前用户名，未登录返回空字符串
+     * @brief 根据会话令牌查找用户，并刷新会话的最近使用时间
+     * @param token 会话令牌
+     * @return 用户名，令牌无效或已过期返回空字符串
      */
-    string get_current_user() const;
+    string resolve_session(const string& token) const;
 
     /**
-     * @brief 获取当前用户完整信息
+     * @brief 检查用户是否还有活跃会话
+     * @param username 用户名
+     * @return 是否有活跃会话
+     */
+    bool has_active_session(const string& username) const;
+
+    /**
+     * @brief 获取用户完整信息
+     * @param username 用户名
      * @return JSON格式的用户信息
      */
-    json get_current_user_info();
+    json get_user_info(const string& username);
 
     /**
-     * @brief 切换用户
+     * @brief 切换用户（结束当前会话并登录新用户）
+     * @param token 当前会话令牌
      * @param username 目标用户名
      * @return JSON格式的切换结果
      */
-    json switch_user(const string& username);
+    json switch_user(const string& token, const string& username);
 
     /**
-     * @brief 用户登出
+     * @brief 用户登出，结束会话
+     * @param token 会话令牌
      * @return JSON格式的登出结果
      */
-    json logout();
+    json logout(const string& token);
 
     /**
      * @brief 获取所有已注册用户列表
+     * @param username 发起请求的用户（用于标记 is_current），可为空
      * @return JSON格式的用户列表
      */
-    json get_user_list();
+    json get_user_list(const string& username = "");
 
     /**
-     * @brief 删除用户（管理功能）
+     * @brief 删除用户（管理功能，同时结束该用户的全部会话）
+     *
+     * 结束会话与删除文件在账户锁内完成，同名用户的登录要等删除结束；
+     * 文件在快照锁内删除，后台压缩不会把已删除的用户重新写回。
+     *
      * @param username 要删除的用户名
+     * @param release 删除文件前调用，用于释放缓存与写回缓冲中该用户的状态
      * @return JSON格式的删除结果
      */
-    json delete_user(const string& username);
-
-    /**
-     * @brief 更新用户最后登录时间
-     * @param username 用户名
-     */
-    void update_last_login(const string& username);
+    json delete_user(const string& username, const function<void()>& release = nullptr);
 
     /**
      * @brief 获取用户统计信息
-     * @param username 用户名，为空则使用当前用户
+     *
+     * 用户已在内存中时由 resident 填入计数与用户信息，包含尚未落盘的修改；
+     * 否则读取快照并重放进度日志。
+     *
+     * @param username 用户名
+     * @param resident 用户在内存中时填入 totals 与 user_info 并返回 true，不在时返回 false
      * @return JSON格式的用户统计
      */
-    json get_user_stats(const string& username = "");
+    json get_user_stats(const string& username,
+                        const function<bool(ProgressTotals& totals, json& user_info)>& resident = nullptr);
 };
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <atomic>
+#include "VocabularyCatalog.h"
+#include "UserProgress.h"
+#include "ProgressSnapshot.h"
+
+using namespace std;
+
+/**
+ * @brief 单个用户的内存状态
+ *
+ * 由 UserDataManager 按用户名加载，同一用户的所有会话共享一份。
+ * 每个请求通过会话令牌找到调用者自己的上下文，不同用户之间互不影响。
+ * 读写进度前需持有 UserDataManager 锁表中该用户的共享锁或独占锁；
+ * 只读请求也可以不加锁，直接读取写者发布的 snapshot。
+ */
+struct UserContext {
+    string username;            ///< 用户名
+    UserProgress progress;      ///< 学习进度（快照 + 已重放的日志）
+    uint64_t log_seq = 0;       ///< 已分配的最大日志序列号
+    atomic<size_t> memory_bytes{0}; ///< 估算的内存占用，修改后更新，供缓存无锁读取
+    atomic<const ProgressSnapshot*> snapshot{nullptr};  ///< 最新发布的只读版本
+
+    UserContext(const string& username, const VocabularyCatalog& catalog)
+        : username(username), progress(catalog) {}
+
+    UserContext(const UserContext&) = delete;
+    UserContext& operator=(const UserContext&) = delete;
+
+    ~UserContext() {
+        // 读者访问快照时持有上下文的引用，析构时已不会有读者
+        delete snapshot.load();
+    }
+};
@@ -2,7 +2,23 @@
 
 #include <string>
 #include <vector>
+#include <memory>
+#include <map>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <condition_variable>
 #include <nlohmann/json.hpp>
+#include "VocabularyCatalog.h"
+#include "UserProgress.h"
+#include "UserProgressLog.h"
+#include "UserProgressFile.h"
+#include "ProgressCompactor.h"
+#include "UserContext.h"
+#include "UserLockTable.h"
+#include "EpochReclaimer.h"
 
 using json = nlohmann::json;
 using namespace std;
@@ -10,33 +26,207 @@ using namespace std;
 /**
  * @brief 用户数据管理类
  * 
- * 负责管理用户的学习数据，包括单词进度、错误统计、学习位置等
+ * 负责管理用户的学习数据，包括单词进度、错误统计、学习位置等。
+ * 每个已登录用户对应一个 UserContext，所有操作都针对调用者传入的上下文，
+ * 多个用户可以同时使用同一个服务实例。
  */
 class UserDataManager {
 private:
-    string current_user;        ///< 当前用户
     string USERS_DIR;          ///< 用户数据目录
-    json user_data;            ///< 当前用户数据
+    const VocabularyCatalog& catalog; ///< 共享词表
 
     /**
-     * @brief 获取用户数据文件路径
-     * @param username 用户名
-     * @return 用户数据文件路径
+     * @brief 上下文缓存中的一项
      */
-    string get_user_data_file(const string& username);
+    struct CacheEntry {
+        shared_ptr<UserContext> context;        ///< 用户上下文
+        list<string>::iterator lru_position;    ///< 在 LRU 链表中的位置
+        size_t bytes = 0;                       ///< 最近一次估算的内存占用
+    };
 
     /**
-     * @brief 加载用户数据
-     * @param username 用户名
+     * @brief 上下文缓存的一个分片（与锁表使用相同的哈希）
+     *
+     * 每个分片是一个独立的 LRU，按分片加锁，不同分片的用户互不阻塞。
+     * 从磁盘加载不持有分片锁：加载中的用户记入 loading，同一用户的其他请求等待同一次加载。
+     * actor 模式下每个分片只由对应的执行器线程访问，不加锁；统计用原子计数，可随时读取。
+     */
+    struct CacheShard {
+        mutex shard_mutex;                  ///< 保护本分片（actor 模式下不使用）
+        map<string, CacheEntry> contexts;   ///< 已加载的用户上下文
+        list<string> lru;                   ///< 用户名，最近使用的在前
+        map<string, shared_future<shared_ptr<UserContext>>> loading; ///< 正在加载的用户
+        atomic<size_t> bytes{0};            ///< 本分片上下文的估算总字节数
+        atomic<size_t> users{0};            ///< 本分片的用户数
+        atomic<uint64_t> hits{0};           ///< 命中次数
+        atomic<uint64_t> misses{0};         ///< 未命中（从磁盘加载）次数
+        atomic<uint64_t> evictions{0};      ///< 淘汰次数
+    };
+
+    UserLockTable user_locks;  ///< 按用户分片的读写锁（读共享、写独占）
+    size_t cache_shard_count;  ///< 缓存分片数（锁模式与锁分片相同，actor 模式与执行器分片相同）
+    bool actor_mode = false;   ///< 是否由执行器线程独占各缓存分片
+    unique_ptr<CacheShard[]> cache_shards; ///< 缓存分片
+    size_t cache_budget;       ///< 缓存字节预算，平均分给各分片
+    unique_ptr<UserProgressFile> progress_file; ///< 二进制快照读写
+    UserProgressLog progress_log; ///< 用户进度追加日志
+    unique_ptr<ProgressCompactor> compactor; ///< 后台日志压缩器
+
+    /**
+     * @brief 写回缓冲的一个分片（与锁表使用相同的哈希）
+     *
+     * 不同分片的用户记入缓冲互不阻塞，落盘时逐个分片取走记录。
+     */
+    struct alignas(64) DirtyShard {
+        mutex shard_mutex;          ///< 保护本分片
+        map<string, vector<UserProgressLog::Record>> records; ///< 各用户尚未落盘的日志记录
+        size_t bytes = 0;           ///< 本分片记录的估算字节数
+    };
+
+    // 写回缓冲：修改只更新内存并记入缓冲区，由后台线程批量追加到进度日志
+    unique_ptr<DirtyShard[]> dirty_shards; ///< 写回缓冲分片，数量与锁表分片相同
+    atomic<size_t> dirty_bytes{0}; ///< 各分片估算字节数之和，落盘线程不加锁读取
+    size_t flush_bytes;        ///< 缓冲字节数达到该值时立即落盘
+    int flush_interval_ms;     ///< 定期落盘间隔（毫秒）
+    bool stopping;             ///< 是否正在停止后台线程
+    mutex flusher_mutex;       ///< 保护 stopping，落盘线程在其上等待
+    mutex flush_mutex;         ///< 串行化落盘过程
+    condition_variable flush_wakeup; ///< 唤醒后台落盘线程
+    thread flusher;            ///< 后台落盘线程
+
+    /**
+     * @brief 加载用户数据（快照 + 进度日志）
+     * @param context 要填充的用户上下文
      * @return 加载是否成功
      */
-    bool load_user_data(const string& username);
+    bool load_user_data(UserContext& context);
 
     /**
-     * @brief 保存用户数据
+     * @brief 保存用户数据快照，成功后截断进度日志
+     * @param context 用户上下文
      * @return 保存是否成功
      */
-    bool save_user_data();
+    bool save_user_data(UserContext& context);
+
+    /**
+     * @brief 为记录分配序列号并放入该用户的写回缓冲
+     *
+     * 只在内存中排队，不做文件 I/O；缓冲超过 flush_bytes 时唤醒后台线程。
+     *
+     * @param context 用户上下文
+     * @param records 要追加的记录
+     * @return 是否成功
+     */
+    bool append_log(UserContext& context, vector<UserProgressLog::Record>& records);
+
+    /**
+     * @brief 按当前进度生成新的只读版本并替换 context.snapshot（调用者需持有独占锁）
+     *
+     * 旧版本交给 EpochReclaimer，等正在读取的请求结束后释放。
+     *
+     * @param context 用户上下文
+     * @param words_changed 单词计数是否变化（未变化时与上一版本共享复习列表，变化时留待读取时生成）
+     */
+    void publish(UserContext& context, bool words_changed);
+
+    /**
+     * @brief 获取当前版本的复习列表，尚未生成时在用户共享锁内生成（调用者需持有 EpochReclaimer::Guard）
+     * @param context 用户上下文
+     * @param snapshot 输出列表所属的版本
+     * @return 按复习索引顺序排列的列表
+     */
+    shared_ptr<const vector<ReviewEntry>> snapshot_review_words(UserContext& context, const ProgressSnapshot*& snapshot);
+
+    /**
+     * @brief 获取用户所在的写回缓冲分片
+     * @param username 用户名
+     * @return 写回缓冲分片
+     */
+    DirtyShard& dirty_shard_of(const string& username);
+
+    /**
+     * @brief 从写回缓冲中取走某个用户的全部记录
+     * @param username 用户名
+     * @param records 输出取走的记录（没有时为空）
+     */
+    void take_dirty(const string& username, vector<UserProgressLog::Record>& records);
+
+    /**
+     * @brief 估算一条记录写入日志后的字节数
+     * @param record 日志记录
+     * @return 估算字节数
+     */
+    size_t record_bytes(const UserProgressLog::Record& record) const;
+
+    /**
+     * @brief 后台落盘线程主循环
+     */
+    void run_flusher();
+
+    /**
+     * @brief 只落盘一个用户缓冲中的日志记录
+     * @param username 用户名
+     * @return 是否写入成功
+     */
+    bool flush_user(const string& username);
+
+    /**
+     * @brief 把写入失败的记录放回写回缓冲，等待下次重试
+     * @param username 用户名
+     * @param records 写入失败的记录
+     */
+    void requeue(const string& username, const vector<UserProgressLog::Record>& records);
+
+    /**
+     * @brief 分片超出预算时淘汰冷用户（调用者需持有分片锁）
+     *
+     * 从最久未使用的用户开始淘汰，跳过正被请求使用的上下文。
+     * 被淘汰用户的缓冲记录由调用者在释放分片锁后落盘。
+     *
+     * @param shard 缓存分片
+     * @param keep 本次访问的用户，不淘汰
+     * @param evicted 追加被淘汰的用户名
+     */
+    void evict_cold_users(CacheShard& shard, const string& keep, vector<string>& evicted);
+
+    /**
+     * @brief 获取用户所在的缓存分片
+     */
+    CacheShard& cache_shard_of(const string& username);
+
+    /**
+     * @brief 锁住缓存分片（actor 模式下返回未加锁的 unique_lock）
+     */
+    unique_lock<mutex> lock_cache(CacheShard& shard);
+
+    // 以下读写学习位置的函数不加锁，由调用者持有用户锁
+
+    /**
+     * @brief 读取学习位置
+     */
+    static int learn_position(const UserContext& context);
+
+    /**
+     * @brief 设置学习位置（位置未变化时不写日志）
+     */
+    bool set_learn_position(UserContext& context, int position);
+
+    /**
+     * @brief 读取复习位置
+     */
+    static int review_position(const UserContext& context);
+
+    /**
+     * @brief 设置复习位置
+     */
+    bool set_review_position(UserContext& context, int position);
+
+    /**
+     * @brief 将快照中的复习单词转换为 JSON
+     * @param entry 复习单词
+     * @return 包含 word、mistakes、correct_count、last_seen 的对象
+     */
+    json review_entry_json(const ReviewEntry& entry) const;
 
 public:
     /**
@@ -45,25 +235,92 @@ public:
     UserDataManager();
 
     /**
-     * @brief 设置当前用户
+     * @brief 析构函数，停止后台线程并落盘剩余记录
+     */
+    ~UserDataManager();
+
+    /**
+     * @brief 将所有用户缓冲中的日志记录追加到磁盘
+     * @return 是否全部写入成功（失败的记录保留在缓冲区中等待重试）
+     */
+    bool flush();
+
+    /**
+     * @brief 停止后台落盘线程并落盘剩余记录（可重复调用）
+     */
+    void shutdown();
+
+    /**
+     * @brief 获取用户上下文
+     *
+     * 缓存命中时不访问文件系统；未命中时在分片锁外从磁盘加载并放入缓存，
+     * 同一用户的并发未命中只加载一次；
+     * 缓存超出预算（环境变量 USER_CACHE_BYTES，默认 64MB）时淘汰冷用户。
+     *
+     * @param username 用户名
+     * @return 用户上下文，加载失败返回空指针
+     */
+    shared_ptr<UserContext> acquire(const string& username);
+
+    /**
+     * @brief 释放用户在内存中的全部状态（删除用户前调用）
+     *
+     * 从缓存中移除上下文，丢弃写回缓冲中尚未落盘的记录并取消待做的压缩，
+     * 返回后不会再有该用户的记录写入日志。
+     *
+     * @param username 用户名
+     */
+    void evict(const string& username);
+
+    /**
+     * @brief 读取已在缓存中的用户的计数与用户信息（不从磁盘加载，也不改变 LRU 顺序）
      * @param username 用户名
-     * @return 设置是否成功
+     * @param totals 输出统计计数（包含尚未落盘的修改）
+     * @param user_info 输出用户信息
+     * @return 用户是否在缓存中
+     */
+    bool read_resident(const string& username, ProgressTotals& totals, json& user_info);
+
+    /**
+     * @brief 获取上下文缓存的统计
+     * @return JSON格式的命中、未命中、淘汰次数与内存占用
+     */
+    json get_cache_stats();
+
+    /**
+     * @brief 切换到 actor 模式（需在处理请求前调用）
+     *
+     * 不再加用户锁与缓存分片锁：缓存按 ShardExecutor 的分片方式（用户名哈希取模）重新分为
+     * shard_count 片，调用者保证 acquire、evict 与针对用户的操作都在该用户所在分片的线程上执行。
+     *
+     * @param shard_count 执行器的分片数
+     */
+    void disable_user_locks(size_t shard_count);
+
+    /**
+     * @brief 获取用户锁表各分片的加锁与争用统计
+     * @return JSON格式的统计
      */
-    bool set_current_user(const string& username);
+    json get_lock_stats() const;
 
     /**
-     * @brief 获取当前用户
-     * @return 当前用户名
+     * @brief 记录一次登录（更新最后登录时间与登录次数并保存）
+     * @param context 用户上下文
+     * @return 保存是否成功
      */
-    string get_current_user() const;
+    bool record_login(UserContext& context);
 
     /**
      * @brief 获取学习单词（分页，支持断点续传）
+     *
+     * 从只读快照读取学习位置，位置需要变化时才加独占锁。
+     *
+     * @param context 用户上下文
      * @param page 页码（从1开始，0表示从上次位置开始）
      * @param words_per_page 每页单词数
      * @return JSON格式的分页单词数据
      */
-    json get_learn_words(int page = 0, int words_per_page = 20);
+    json get_learn_words(UserContext& context, int page = 0, int words_per_page = 20);
 
     /**
      * @brief 获取考试单词（随机）
@@ -74,87 +331,115 @@ public:
 
     /**
      * @brief 批量更新错误次数
+     * @param context 用户上下文
      * @param words_to_update 需要增加错误计数的单词列表
      * @return 操作是否成功
      */
-    bool update_mistakes_batch(const vector<string>& words_to_update);
+    bool update_mistakes_batch(UserContext& context, const vector<string>& words_to_update);
 
     /**
      * @brief 批量更新正确次数
+     * @param context 用户上下文
      * @param words_correct 正确的单词列表
      * @return 操作是否成功
      */
-    bool update_correct_batch(const vector<string>& words_correct);
+    bool update_correct_batch(UserContext& context, const vector<string>& words_correct);
 
     /**
      * @brief 获取复习单词列表（支持分页）
+     * @param context 用户上下文
      * @param page 页码（从1开始，0表示从上次位置开始）
      * @param words_per_page 每页单词数
      * @return JSON格式的复习单词数据（按错误次数排序）
      */
-    json get_review_words(int page = 1, int words_per_page = 20);
+    json get_review_words(UserContext& context, int page = 1, int words_per_page = 20);
 
     /**
      * @brief 获取所有复习单词列表（用于侧边栏显示）
+     *
+     * 读取只读快照，不加锁。
+     *
+     * @param context 用户上下文
      * @return JSON格式的所有复习单词数据
      */
-    json get_all_review_words();
+    json get_all_review_words(UserContext& context);
 
     /**
      * @brief 获取学习统计信息
+     *
+     * 读取只读快照，不加锁。
+     *
+     * @param context 用户上下文
      * @return JSON格式的统计数据
      */
-    json get_stats();
+    json get_stats(UserContext& context);
+
+    /**
+     * @brief 全量重新统计并与增量计数比对（调试用）
+     *
+     * 计数不一致时以全量统计结果修正增量计数。
+     *
+     * @param context 用户上下文
+     * @return JSON格式的比对结果（drift 表示是否存在偏差）
+     */
+    json recount_stats(UserContext& context);
 
     /**
      * @brief 更新学习位置
+     * @param context 用户上下文
      * @param position 新的学习位置
      * @return 更新是否成功
      */
-    bool update_learn_position(int position);
+    bool update_learn_position(UserContext& context, int position);
 
     /**
      * @brief 获取学习位置
+     * @param context 用户上下文
      * @return 当前学习位置
      */
-    int get_learn_position();
+    int get_learn_position(const UserContext& context);
 
     /**
      * @brief 更新复习位置
+     * @param context 用户上下文
      * @param position 新的复习位置
      * @return 更新是否成功
      */
-    bool update_review_position(int position);
+    bool update_review_position(UserContext& context, int position);
 
     /**
      * @brief 获取复习位置
+     * @param context 用户上下文
      * @return 当前复习位置
      */
-    int get_review_position();
+    int get_review_position(const UserContext& context);
 
     /**
      * @brief 重置用户进度
+     * @param context 用户上下文
      * @param reset_mistakes 是否重置错误统计
      * @param reset_position 是否重置学习位置
      * @return JSON格式的重置结果
      */
-    json reset_progress(bool reset_mistakes = false, bool reset_position = true);
+    json reset_progress(UserContext& context, bool reset_mistakes = false, bool reset_position = true);
 
     /**
      * @brief 获取用户学习历史
+     * @param context 用户上下文
      * @param limit 返回记录数限制
      * @return JSON格式的学习历史
      */
-    json get_learning_history(int limit = 50);
+    json get_learning_history(UserContext& context, int limit = 50);
 
     /**
      * @brief 记录学习会话
+     * @param context 用户上下文
      * @param session_type 会话类型（learn/exam/review）
      * @param words_count 学习单词数
      * @param correct_count 正确数
      * @param duration 学习时长（秒）
      * @return 记录是否成功
      */
-    bool record_learning_session(const string& session_type, int words_count, 
+    bool record_learning_session(UserContext& context, const string& session_type, int words_count, 
                                 int correct_count, int duration);
 };
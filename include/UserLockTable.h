@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 按用户分片的读写锁表
+ *
+ * 用户名哈希到固定数量的分片，每个分片一把读写锁：读操作持有共享锁，
+ * 修改持有独占锁。不同分片的用户互不阻塞，没有全局锁，活跃用户多时吞吐随核数增长。
+ * 每个分片统计加锁次数与发生争用（需要等待）的次数。
+ */
+class UserLockTable {
+public:
+    /**
+     * @brief 构造函数
+     * @param shard_count 分片数
+     */
+    explicit UserLockTable(size_t shard_count = 64);
+
+    UserLockTable(const UserLockTable&) = delete;
+    UserLockTable& operator=(const UserLockTable&) = delete;
+
+    /**
+     * @brief 获取用户的共享锁（读）
+     * @param username 用户名
+     * @return 已加锁的共享锁
+     */
+    shared_lock<shared_mutex> lock_shared(const string& username);
+
+    /**
+     * @brief 获取用户的独占锁（写）
+     * @param username 用户名
+     * @return 已加锁的独占锁
+     */
+    unique_lock<shared_mutex> lock_exclusive(const string& username);
+
+    /**
+     * @brief 停用锁表，之后 lock_shared/lock_exclusive 返回不持有锁的空锁
+     *
+     * 用于同一用户的操作已由 ShardExecutor 串行化的 actor 模式，需在处理请求前调用。
+     */
+    void disable();
+
+    /**
+     * @brief 计算用户所在的分片
+     * @param username 用户名
+     * @return 分片下标
+     */
+    size_t shard_of(const string& username) const;
+
+    /**
+     * @brief 获取分片数
+     */
+    size_t shard_count() const;
+
+    /**
+     * @brief 获取各分片的加锁与争用统计
+     * @return JSON格式的统计（只列出使用过的分片）
+     */
+    json get_stats() const;
+
+private:
+    /**
+     * @brief 一个锁分片，按缓存行对齐避免伪共享
+     */
+    struct alignas(64) Shard {
+        shared_mutex mutex;                         ///< 分片读写锁
+        atomic<uint64_t> shared_acquisitions{0};    ///< 共享锁次数
+        atomic<uint64_t> exclusive_acquisitions{0}; ///< 独占锁次数
+        atomic<uint64_t> contended{0};              ///< 需要等待的次数
+    };
+
+    size_t count;                   ///< 分片数
+    unique_ptr<Shard[]> shards;     ///< 分片数组
+    bool enabled = true;            ///< 是否加锁
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "VocabularyCatalog.h"
+#include "UserProgressLog.h"
+#include "ProgressKernels.h"
+#include "ReviewIndex.h"
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 单个单词的学习进度
+ */
+struct WordProgress {
+    uint16_t mistakes = 0;       ///< 错误次数
+    uint16_t correct_count = 0;  ///< 正确次数
+    uint32_t last_seen = 0;      ///< 最后一次出现的时间
+
+    /**
+     * @brief 是否为默认值（从未被学习过）
+     * @return 是否全为0
+     */
+    bool is_default() const {
+        return mistakes == 0 && correct_count == 0 && last_seen == 0;
+    }
+};
+
+/**
+ * @brief 一个用户的完整学习数据
+ *
+ * user_info 保持 JSON 格式（字段少且对外原样返回）。
+ * 单词进度按结构数组存放：mistakes[]、correct[]、last_seen[] 三个连续数组，
+ * 以词表 id 为下标，全词表扫描（统计、复习列表）只需顺序读取连续内存。
+ * JSON 只在接口边界（旧版文件、调试工具）使用。
+ *
+ * 复习单词数、错误总数、正确总数随每次修改增量维护，读取统计为 O(1)；
+ * 复习单词同时维护在有序索引中，分页读取不需要扫描排序。
+ */
+class UserProgress {
+public:
+    json user_info;         ///< 用户信息（用户名、创建时间、学习位置等）
+    uint64_t log_seq = 0;   ///< 已合并的进度日志序列号
+
+    /**
+     * @brief 构造空的用户数据（不含任何单词）
+     */
+    UserProgress() = default;
+
+    /**
+     * @brief 构造用户数据，所有单词的计数为0
+     * @param catalog 词表（需比本对象存活更久）
+     */
+    explicit UserProgress(const VocabularyCatalog& catalog);
+
+    /**
+     * @brief 获取单词数量（即数组长度）
+     * @return 单词数量
+     */
+    size_t size() const;
+
+    /**
+     * @brief 估算占用的内存（计数数组、复习索引与用户信息）
+     * @return 字节数
+     */
+    size_t memory_usage() const;
+
+    /**
+     * @brief 获取单词进度
+     * @param id 单词 id
+     * @return 单词进度，超出范围时返回默认值
+     */
+    WordProgress get(uint32_t id) const;
+
+    /**
+     * @brief 设置单词进度
+     * @param id 单词 id
+     * @param progress 单词进度（超出范围的 id 被忽略）
+     */
+    void set(uint32_t id, const WordProgress& progress);
+
+    /**
+     * @brief 应用一条进度日志记录
+     * @param record 日志记录（word_id 必须已在当前词表中）
+     */
+    void apply(const UserProgressLog::Record& record);
+
+    /**
+     * @brief 清空所有单词进度
+     */
+    void clear_words();
+
+    /**
+     * @brief 获取增量维护的聚合值
+     * @return 复习单词数、错误总数、正确总数
+     */
+    const ProgressTotals& get_totals() const;
+
+    /**
+     * @brief 扫描全部数组重新计算聚合值（不修改增量计数）
+     * @return 重新计算的聚合值
+     */
+    ProgressTotals recount() const;
+
+    /**
+     * @brief 用全量扫描的结果覆盖增量计数
+     */
+    void rebuild_totals();
+
+    /**
+     * @brief 获取复习单词的有序索引
+     * @return 按 (错误次数降序, 最后见到时间升序, 单词) 排列的索引
+     */
+    const ReviewIndex& get_review_index() const;
+
+    /**
+     * @brief 获取错误次数数组
+     * @return 以 id 为下标的数组，长度为 size()
+     */
+    const uint16_t* mistakes() const;
+
+    /**
+     * @brief 获取正确次数数组
+     * @return 以 id 为下标的数组，长度为 size()
+     */
+    const uint16_t* correct() const;
+
+    /**
+     * @brief 获取最后出现时间数组
+     * @return 以 id 为下标的数组，长度为 size()
+     */
+    const uint32_t* last_seen() const;
+
+    /**
+     * @brief 转换为旧版 JSON 结构（{"user_info", "words"}）
+     * @param catalog 词表
+     * @return JSON 格式的用户数据（只包含非默认的单词）
+     */
+    json to_json(const VocabularyCatalog& catalog) const;
+
+    /**
+     * @brief 从旧版 JSON 结构构造
+     * @param user_data JSON 格式的用户数据
+     * @param catalog 词表，不在词表中的单词被忽略
+     * @return 用户数据
+     */
+    static UserProgress from_json(const json& user_data, const VocabularyCatalog& catalog);
+
+private:
+    vector<uint16_t> mistake_counts;    ///< 错误次数，按 id 排列
+    vector<uint16_t> correct_counts;    ///< 正确次数，按 id 排列
+    vector<uint32_t> last_seen_times;   ///< 最后出现时间，按 id 排列
+    ProgressTotals totals;              ///< 增量维护的聚合值
+    ReviewIndex review_index;           ///< 复习单词有序索引
+
+    /**
+     * @brief 修改单词进度并同步更新聚合值与复习索引
+     * @param id 单词 id（需在范围内）
+     * @param mistakes 新的错误次数
+     * @param correct 新的正确次数
+     * @param last_seen 新的最后出现时间
+     */
+    void update_word(uint32_t id, uint16_t mistakes, uint16_t correct, uint32_t last_seen);
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "VocabularyCatalog.h"
+#include "UserProgress.h"
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 用户进度快照的二进制存储格式
+ *
+ * 每个用户一个 <name>.dat 文件（小端序）：
+ *
+ *   偏移  大小  字段
+ *   0     4     magic "WPRG"
+ *   4     2     版本号
+ *   6     2     单条记录字节数（12）
+ *   8     8     词表指纹（FNV-1a 64）
+ *   16    4     记录数
+ *   20    4     user_info 长度
+ *   24    8     已合并的日志序列号（log_seq）
+ *   32    4     复习单词数（mistakes > 0）
+ *   36    4     保留（0）
+ *   40    8     错误次数总和
+ *   48    8     正确次数总和
+ *   56    n     user_info（紧凑 JSON）
+ *   56+n  12*k  稀疏记录数组，只包含计数非默认的单词：
+ *               uint32 单词 id（words.txt 行序）, uint16 mistakes,
+ *               uint16 correct_count, uint32 last_seen
+ *
+ * 统计计数在加载时与记录数组的全量统计比对，不一致时输出警告并以全量统计为准。
+ *
+ * 版本1为稠密格式：每个单词一条 8 字节记录（无 id 字段），仍可读取。
+ * 版本1、2的文件头为 32 字节，不含统计计数。
+ *
+ * 没有 .dat 的旧用户从 <name>.json 读取，下次保存时迁移为 .dat。
+ *
+ * 每个出现过的词表都会以 .vocab/<指纹>.txt 保存一份，
+ * 词表变化后旧文件仍能按单词重新映射到新的 id。
+ */
+class UserProgressFile {
+public:
+    static constexpr uint16_t FORMAT_VERSION = 3;  ///< 当前格式版本
+    static constexpr size_t HEADER_SIZE = 56;      ///< 文件头字节数
+    static constexpr size_t BASE_HEADER_SIZE = 32; ///< 版本1、2的文件头字节数
+    static constexpr size_t RECORD_SIZE = 12;      ///< 单条稀疏记录字节数
+    static constexpr size_t DENSE_RECORD_SIZE = 8; ///< 版本1稠密记录字节数
+
+    /**
+     * @brief 构造函数
+     * @param users_dir 用户数据目录
+     * @param catalog 当前词表（需比本对象存活更久）
+     */
+    UserProgressFile(const string& users_dir, const VocabularyCatalog& catalog);
+
+    /**
+     * @brief 获取用户二进制数据文件路径
+     * @param username 用户名
+     * @return 数据文件路径
+     */
+    string get_data_file(const string& username) const;
+
+    /**
+     * @brief 获取旧版 JSON 数据文件路径
+     * @param username 用户名
+     * @return JSON 文件路径
+     */
+    string get_legacy_file(const string& username) const;
+
+    /**
+     * @brief 检查用户数据是否存在（二进制或旧版 JSON）
+     * @param username 用户名
+     * @return 是否存在
+     */
+    bool exists(const string& username) const;
+
+    /**
+     * @brief 读取用户快照
+     * @param username 用户名
+     * @param progress 输出的用户数据
+     * @return 读取是否成功
+     */
+    bool load(const string& username, UserProgress& progress) const;
+
+    /**
+     * @brief 只读取用户信息（不解码单词记录）
+     * @param username 用户名
+     * @param user_info 输出的 user_info
+     * @return 读取是否成功
+     */
+    bool load_info(const string& username, json& user_info) const;
+
+    /**
+     * @brief 原子写入用户快照，并删除旧版 JSON 文件
+     * @param username 用户名
+     * @param progress 用户数据
+     * @return 写入是否成功
+     */
+    bool save(const string& username, const UserProgress& progress) const;
+
+    /**
+     * @brief 删除用户快照（二进制与旧版 JSON）
+     * @param username 用户名
+     */
+    void remove(const string& username) const;
+
+    /**
+     * @brief 列出所有已存储的用户
+     * @return 用户名列表
+     */
+    vector<string> list_users() const;
+
+    /**
+     * @brief 获取词表
+     * @return 当前词表
+     */
+    const VocabularyCatalog& get_catalog() const;
+
+    /**
+     * @brief 编码用户数据
+     * @param progress 用户数据
+     * @return 二进制内容
+     */
+    string encode(const UserProgress& progress) const;
+
+    /**
+     * @brief 解码用户数据
+     *
+     * 文件中的词表指纹与当前词表不一致时，按 .vocab 目录中保存的旧词表
+     * 逐词映射；找不到旧词表则解码失败。
+     *
+     * @param bytes 二进制内容
+     * @param progress 输出的用户数据
+     * @return 解码是否成功
+     */
+    bool decode(const string& bytes, UserProgress& progress) const;
+
+private:
+    string USERS_DIR;                   ///< 用户数据目录
+    string VOCAB_DIR;                   ///< 历史词表目录
+    const VocabularyCatalog* catalog;   ///< 当前词表
+};
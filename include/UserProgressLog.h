@@ -0,0 +1,167 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <mutex>
+#include "VocabularyCatalog.h"
+
+using namespace std;
+
+/**
+ * @brief 用户进度追加日志（预写日志）
+ *
+ * 每个用户对应一个 data/users/<name>.log 文件，每次变更只追加被修改单词的记录，
+ * 而不是重写整个用户数据文件。加载用户数据时在快照之上重放日志，
+ * 保存快照后日志被截断。
+ *
+ * 每行一条记录：<seq> <op> <value> <timestamp> <key>
+ * （key 放在行尾，单词本身可能含空格，例如 "ozone layer"）
+ * 内存中的记录按词表 id 引用单词，落盘时仍写单词文本，
+ * 词表变化后旧日志依然可以按单词重新映射。
+ *   - op = 'm'：单词 key 的错误次数增加 value，并更新 last_seen
+ *   - op = 'c'：单词 key 的正确次数增加 value，并更新 last_seen
+ *   - op = 'l'：学习位置设为 value（key 为 "-"）
+ *   - op = 'r'：复习位置设为 value（key 为 "-"）
+ *
+ * seq 单调递增，快照中记录已合并的最大 seq，重放时跳过不大于它的记录，
+ * 因此快照写入后、日志截断前崩溃也不会重复计数。追加失败的一批记录可能已部分写入，
+ * 重试时整批再写一次；重放时同样跳过不大于已读到的最大 seq 的记录，重复的部分只计一次。
+ *
+ * 每条记录以换行结尾。崩溃留下的没有换行的残行在重放时丢弃，
+ * 并在下一次追加前从文件中截掉，新记录不会接在残行后面。
+ *
+ * 后台压缩时，日志先被轮转为 <name>.log.compacting，新记录继续写入新的
+ * <name>.log；重放时两个文件都会被读取。
+ */
+class UserProgressLog {
+public:
+    /**
+     * @brief 日志记录
+     */
+    struct Record {
+        uint64_t seq = 0;       ///< 序列号
+        char op = 0;            ///< 操作类型
+        uint32_t word_id = VocabularyCatalog::NOT_FOUND; ///< 单词 id（位置记录为 NOT_FOUND）
+        long value = 0;         ///< 增量或新位置
+        long timestamp = 0;     ///< 记录时间
+    };
+
+    static constexpr char OP_MISTAKE = 'm';         ///< 错误次数增量
+    static constexpr char OP_CORRECT = 'c';         ///< 正确次数增量
+    static constexpr char OP_LEARN_POSITION = 'l';  ///< 学习位置
+    static constexpr char OP_REVIEW_POSITION = 'r'; ///< 复习位置
+
+    /**
+     * @brief 构造函数
+     * @param users_dir 用户数据目录
+     * @param catalog 词表（需比日志对象存活更久）
+     */
+    UserProgressLog(const string& users_dir, const VocabularyCatalog& catalog);
+
+    /**
+     * @brief 获取用户日志文件路径
+     * @param username 用户名
+     * @return 日志文件路径
+     */
+    string get_log_file(const string& username) const;
+
+    /**
+     * @brief 获取正在压缩的日志文件路径
+     * @param username 用户名
+     * @return 轮转后的日志文件路径
+     */
+    string get_compacting_file(const string& username) const;
+
+    /**
+     * @brief 追加记录（一次写入）
+     * @param username 用户名
+     * @param records 要追加的记录，seq 需由调用方分配
+     * @return 追加是否成功
+     */
+    bool append(const string& username, const vector<Record>& records);
+
+    /**
+     * @brief 重放日志
+     * @param username 用户名
+     * @param applied_seq 快照中已合并的序列号，不大于它的记录被跳过
+     * @param apply 每条有效记录的回调（不在词表中的单词已被跳过）
+     * @return 日志中出现的最大序列号（无记录时返回 applied_seq）
+     */
+    uint64_t replay(const string& username, uint64_t applied_seq,
+                    const function<void(const Record&)>& apply) const;
+
+    /**
+     * @brief 截断日志（快照保存之后调用），同时删除轮转中的日志
+     * @param username 用户名
+     * @return 操作是否成功
+     */
+    bool truncate(const string& username);
+
+    /**
+     * @brief 将当前日志轮转为待压缩日志
+     *
+     * 只在日志锁内做一次重命名，正在追加的请求最多等待这一步。
+     * 如果上次压缩中断留下了待压缩日志，则不再轮转，先压缩已有文件。
+     *
+     * @param username 用户名
+     * @return 是否存在待压缩日志
+     */
+    bool rotate(const string& username);
+
+    /**
+     * @brief 删除已合并进快照的待压缩日志
+     * @param username 用户名
+     */
+    void remove_compacting(const string& username);
+
+    /**
+     * @brief 获取日志当前大小（字节）
+     * @param username 用户名
+     * @return 日志大小，不存在时为0
+     */
+    uintmax_t size(const string& username) const;
+
+    /**
+     * @brief 删除用户日志
+     * @param username 用户名
+     */
+    void remove(const string& username);
+
+    /**
+     * @brief 获取用户快照锁
+     *
+     * 所有写 <name>.json 快照的路径（保存、压缩、登录时间更新）都需要持有它。
+     * 锁是进程级的，不随 UserProgressLog 实例变化。
+     *
+     * @param username 用户名
+     * @return 快照互斥量
+     */
+    static mutex& snapshot_mutex(const string& username);
+
+    /**
+     * @brief 重放单个日志文件
+     * @param path 日志文件路径
+     * @param catalog 用于解析单词的词表
+     * @param applied_seq 已合并的序列号，不大于它的记录被跳过
+     * @param last_seq 之前的文件中已重放的最大序列号，不大于它的记录同样被跳过
+     * @param apply 每条有效记录的回调
+     * @return 重放后的最大序列号
+     */
+    static uint64_t replay_file(const string& path, const VocabularyCatalog& catalog,
+                                uint64_t applied_seq, uint64_t last_seq,
+                                const function<void(const Record&)>& apply);
+
+private:
+    string USERS_DIR;                   ///< 用户数据目录
+    const VocabularyCatalog* catalog;   ///< 词表
+
+    /**
+     * @brief 获取用户日志锁（保护追加、轮转与截断）
+     * @param username 用户名
+     * @return 日志互斥量
+     */
+    static mutex& log_mutex(const string& username);
+
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief 进程级共享的只读词表
+ *
+ * 启动时从 data/words.txt 加载一次，为每个单词分配稠密的整数 id（即文件行序），
+ * 提供 O(1) 的单词到 id 查找和预先排好的字母顺序。
+ * 所有用户共享同一份词表，用户数据只按 id 引用单词。
+ */
+class VocabularyCatalog {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;  ///< 单词不在词表中
+
+    /**
+     * @brief 从单词文件构造词表
+     * @param words_file 单词文件路径（每行一个单词）
+     * @param learn_order 学习顺序："alphabetical"（字母顺序）或 "file"（words.txt 行序）
+     */
+    explicit VocabularyCatalog(const string& words_file, const string& learn_order = "alphabetical");
+
+    /**
+     * @brief 从单词列表构造词表
+     * @param words 按 id 排列的单词
+     * @param learn_order 学习顺序，同上
+     */
+    explicit VocabularyCatalog(vector<string> words, const string& learn_order = "alphabetical");
+
+    /**
+     * @brief 获取进程级共享词表（首次调用时加载）
+     *
+     * 学习顺序由环境变量 LEARN_ORDER 配置，默认为字母顺序。
+     *
+     * @return 词表实例
+     */
+    static const VocabularyCatalog& instance();
+
+    /**
+     * @brief 获取单词数量
+     * @return 单词数量
+     */
+    size_t size() const;
+
+    /**
+     * @brief 按 id 获取单词
+     * @param id 单词 id
+     * @return 单词
+     */
+    const string& word(uint32_t id) const;
+
+    /**
+     * @brief 查找单词 id
+     * @param word 单词
+     * @return 单词 id，不存在时返回 NOT_FOUND
+     */
+    uint32_t id_of(const string& word) const;
+
+    /**
+     * @brief 检查单词是否在词表中
+     * @param word 单词
+     * @return 是否存在
+     */
+    bool contains(const string& word) const;
+
+    /**
+     * @brief 获取全部单词（按 id 排列）
+     * @return 单词列表
+     */
+    const vector<string>& words() const;
+
+    /**
+     * @brief 获取按字母顺序排列的单词 id
+     * @return 排序后的 id 列表
+     */
+    const vector<uint32_t>& sorted_ids() const;
+
+    /**
+     * @brief 获取学习顺序（所有用户共享，加载时计算一次）
+     * @return 按学习顺序排列的 id 列表
+     */
+    const vector<uint32_t>& learn_order() const;
+
+    /**
+     * @brief 获取每个单词在字母顺序中的名次
+     * @return 以 id 为下标的名次数组（sorted_ids 的逆映射）
+     */
+    const vector<uint32_t>& alphabetical_ranks() const;
+
+    /**
+     * @brief 获取词表指纹
+     * @return FNV-1a 64位哈希
+     */
+    uint64_t fingerprint() const;
+
+    /**
+     * @brief 获取十六进制形式的词表指纹
+     * @return 16位十六进制字符串
+     */
+    string fingerprint_hex() const;
+
+    /**
+     * @brief 将词表副本保存到 <vocab_dir>/<指纹>.txt（已存在则跳过）
+     *
+     * 用户文件和进度日志按 id 引用单词，词表变化后需要旧词表才能重新映射。
+     *
+     * @param vocab_dir 历史词表目录
+     * @return 是否保存成功
+     */
+    bool save_copy(const string& vocab_dir) const;
+
+    /**
+     * @brief 按指纹加载历史词表
+     * @param vocab_dir 历史词表目录
+     * @param fingerprint 词表指纹
+     * @return 词表，找不到或指纹不符时返回空
+     */
+    static unique_ptr<VocabularyCatalog> load_copy(const string& vocab_dir, uint64_t fingerprint);
+
+    /**
+     * @brief 读取单词文件
+     * @param words_file 文件路径
+     * @return 单词列表（已去除行尾空白，跳过空行）
+     */
+    static vector<string> read_words_file(const string& words_file);
+
+    /**
+     * @brief 计算词表指纹
+     * @param words 单词列表
+     * @return FNV-1a 64位哈希
+     */
+    static uint64_t compute_fingerprint(const vector<string>& words);
+
+    /**
+     * @brief 将指纹格式化为十六进制
+     * @param fingerprint 词表指纹
+     * @return 16位十六进制字符串
+     */
+    static string to_hex(uint64_t fingerprint);
+
+private:
+    vector<string> word_list;                   ///< 按 id 排列的单词
+    unordered_map<string, uint32_t> word_ids;   ///< 单词到 id 的索引
+    vector<uint32_t> alphabetical;              ///< 按字母顺序排列的 id
+    vector<uint32_t> ranks;                     ///< 每个 id 的字母序名次
+    vector<uint32_t> file_order;                ///< 按 words.txt 行序排列的 id（仅在配置为 file 时使用）
+    bool use_file_order = false;                ///< 学习顺序是否为 words.txt 行序
+    uint64_t vocabulary_fingerprint;            ///< 词表指纹
+
+    /**
+     * @brief 根据 word_list 构建索引
+     * @param learn_order 学习顺序配置
+     */
+    void build_index(const string& learn_order);
+};
@@ -3,9 +3,12 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include "UserAuth.h"
 #include "UserDataManager.h"
+#include "ShardExecutor.h"
+#include "DictionaryClient.h"
 
 using json = nlohmann::json;
 using namespace std;
@@ -19,6 +22,40 @@ class WordApp {
 private:
     UserAuth auth_manager;              ///< 用户认证管理器
     UserDataManager data_manager;       ///< 用户数据管理器
+    unique_ptr<ShardExecutor> executor; ///< actor 模式的分片执行器（锁模式下为空）
+    DictionaryClient dictionary;        ///< 在线词典客户端（连接池）
+
+    /**
+     * @brief 执行针对某个用户的数据操作
+     *
+     * 锁模式下直接在请求线程执行；actor 模式下投递到该用户所在分片的线程并等待结果。
+     * 获取、加载与淘汰上下文也经过这里，actor 模式下缓存只被分片线程访问。
+     *
+     * @param username 用户名
+     * @param task 操作
+     * @return 操作的返回值
+     */
+    template <typename Task>
+    auto on_user_shard(const string& username, Task task) -> decltype(task()) {
+        if (!executor) {
+            return task();
+        }
+        return executor->run(username, task);
+    }
+
+    /**
+     * @brief 执行针对某个用户上下文的数据操作
+     */
+    template <typename Task>
+    auto on_user_shard(const UserContext& context, Task task) -> decltype(task()) {
+        return on_user_shard(context.username, task);
+    }
+
+    /**
+     * @brief 获取用户上下文并记录一次登录
+     * @param username 用户名
+     */
+    void load_and_record_login(const string& username);
 
     /**
      * @brief 获取本地词典数据
@@ -60,8 +97,9 @@ private:
 public:
     /**
      * @brief 构造函数，初始化应用
+     * @param dictionary_options 在线词典的地址、超时与连接数
      */
-    WordApp();
+    explicit WordApp(const DictionaryClient::Options& dictionary_options = DictionaryClient::Options());
 
     /**
      * @brief 初始化数据文件
@@ -72,11 +110,12 @@ public:
 
     /**
      * @brief 获取学习单词（分页）
+     * @param context 调用者的用户上下文
      * @param page 页码（从1开始）
      * @param words_per_page 每页单词数
      * @return JSON格式的分页单词数据
      */
-    json get_learn_words(int page = 1, int words_per_page = 20);
+    json get_learn_words(UserContext& context, int page = 1, int words_per_page = 20);
 
     /**
      * @brief 获取考试单词（随机）
@@ -86,30 +125,64 @@ public:
 
     /**
      * @brief 批量更新错误次数
+     * @param context 调用者的用户上下文
      * @param words_to_update 需要增加错误计数的单词列表
      * @return 操作是否成功
      */
-    bool update_mistakes_batch(const vector<string>& words_to_update);
+    bool update_mistakes_batch(UserContext& context, const vector<string>& words_to_update);
 
     /**
      * @brief 获取复习单词列表（分页）
+     * @param context 调用者的用户上下文
      * @param page 页码（从1开始）
      * @param words_per_page 每页单词数
      * @return JSON格式的复习单词数据（按错误次数排序）
      */
-    json get_review_words(int page = 1, int words_per_page = 20);
+    json get_review_words(UserContext& context, int page = 1, int words_per_page = 20);
 
     /**
      * @brief 获取所有复习单词列表（用于侧边栏显示）
+     * @param context 调用者的用户上下文
      * @return JSON格式的所有复习单词数据
      */
-    json get_all_review_words();
+    json get_all_review_words(UserContext& context);
 
     /**
      * @brief 获取学习统计信息
+     * @param context 调用者的用户上下文
      * @return JSON格式的统计数据
      */
-    json get_stats();
+    json get_stats(UserContext& context);
+
+    /**
+     * @brief 全量重新统计并报告增量计数的偏差（调试用）
+     * @param context 调用者的用户上下文
+     * @return JSON格式的比对结果
+     */
+    json recount_stats(UserContext& context);
+
+    /**
+     * @brief 获取用户上下文缓存的统计（调试用）
+     * @return JSON格式的命中、未命中、淘汰次数与内存占用
+     */
+    json get_cache_stats();
+
+    /**
+     * @brief 获取用户锁各分片的争用统计（调试用）
+     * @return JSON格式的执行模式、加锁与争用次数（actor 模式下附带各分片的任务统计）
+     */
+    json get_lock_stats();
+
+    /**
+     * @brief 获取在线词典连接池的统计（调试用）
+     * @return JSON格式的请求数、失败数、连接数与平均耗时
+     */
+    json get_dictionary_stats();
+
+    /**
+     * @brief 停止分片执行器与后台落盘，写入所有未保存的学习进度（退出前调用）
+     */
+    void shutdown();
 
     /**
      * @brief 词典搜索功能
@@ -123,7 +196,7 @@ public:
     /**
      * @brief 用户登录
      * @param username 用户名
-     * @return JSON格式的登录结果
+     * @return JSON格式的登录结果（成功时包含 session_token）
      */
     json login_user(const string& username);
 
@@ -134,30 +207,41 @@ public:
      */
     json register_user(const string& username);
 
+    /**
+     * @brief 根据会话令牌获取调用者的用户上下文
+     * @param token 会话令牌（来自 Cookie 或 X-Session-Token 头）
+     * @return 用户上下文，未登录或加载失败返回空指针
+     */
+    shared_ptr<UserContext> get_user_context(const string& token);
+
     /**
      * @brief 获取当前用户信息
+     * @param token 会话令牌
      * @return JSON格式的用户信息
      */
-    json get_current_user();
+    json get_current_user(const string& token);
 
     /**
      * @brief 切换用户
+     * @param token 当前会话令牌
      * @param username 新用户名
-     * @return JSON格式的切换结果
+     * @return JSON格式的切换结果（包含新的 session_token）
      */
-    json switch_user(const string& username);
+    json switch_user(const string& token, const string& username);
 
     /**
      * @brief 用户登出
+     * @param token 会话令牌
      * @return JSON格式的登出结果
      */
-    json logout_user();
+    json logout_user(const string& token);
 
     /**
      * @brief 获取所有用户列表
+     * @param token 会话令牌（用于标记当前用户），可为空
      * @return JSON格式的用户列表
      */
-    json get_user_list();
+    json get_user_list(const string& token);
 
     /**
      * @brief 删除用户
@@ -166,13 +250,21 @@ public:
      */
     json delete_user(const string& username);
 
+    /**
+     * @brief 获取用户统计（管理功能，用户在缓存中时取内存中的最新进度）
+     * @param username 用户名
+     * @return JSON格式的用户统计
+     */
+    json get_user_stats(const string& username);
+
     // ===== 用户数据管理方法 =====
 
     /**
      * @brief 重置用户学习进度
+     * @param context 调用者的用户上下文
      * @param reset_mistakes 是否重置错误记录
      * @param reset_position 是否重置学习位置
      * @return JSON格式的重置结果
      */
-    json reset_user_progress(bool reset_mistakes = false, bool reset_position = true);
+    json reset_user_progress(UserContext& context, bool reset_mistakes = false, bool reset_position = true);
 };
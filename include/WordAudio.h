@@ -0,0 +1,222 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include "AudioPack.h"
+#include "SpeechEngine.h"
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 通过 HTTP 下发的单词音频
+ *
+ * 单词优先取自音频包（直接引用映射内存），否则用 SpeechEngine 现场合成并放入
+ * 有界缓存；浏览器的 <audio> 会对同一地址反复发 Range 请求，缓存避免重复合成。
+ * 单词序列由各单词的 PCM 与单词间的静音拼成一个 WAV。
+ *
+ * 下发内容只由单词、停顿与合成引擎决定。ETag 由各单词音频的内容哈希与停顿组合而成，
+ * 是强校验值；音频包的哈希在生成时算好，现场合成的在放入缓存时算一次，发送时不再哈希内容。
+ */
+class WordAudio {
+public:
+    /**
+     * @brief 一段长度已知的响应内容（按顺序拼接的若干片段）
+     */
+    struct Body {
+        vector<string_view> parts;                  ///< 内容片段（指向音频包、缓存或 owners）
+        vector<shared_ptr<const string>> owners;    ///< 保持片段所指内存存活
+        size_t size = 0;                            ///< 总字节数
+        uint64_t digest = 14695981039346656037ull;  ///< 各段单词音频的内容哈希与停顿的组合
+
+        /**
+         * @brief 追加片段
+         * @param part 片段
+         */
+        void append(string_view part);
+
+        /**
+         * @brief 追加片段并持有其内存
+         * @param part 片段
+         */
+        void append(shared_ptr<const string> part);
+
+        /**
+         * @brief 把一个值（单词音频的内容哈希或停顿长度）按 FNV-1a 并入 digest
+         * @param value 要并入的值
+         */
+        void add_digest(uint64_t value);
+
+        /**
+         * @brief 获取 ETag（digest 的十六进制，带引号）
+         */
+        string etag() const;
+
+        /**
+         * @brief 输出 [offset, offset + length) 范围内的字节，不复制片段
+         * @param offset 起始偏移
+         * @param length 字节数
+         * @param write 写出函数，返回 false 时停止
+         * @return 是否全部写出
+         */
+        bool write(size_t offset, size_t length, const function<bool(const char*, size_t)>& write) const;
+    };
+
+    /**
+     * @brief 单词序列的流水线合成
+     *
+     * 后台线程按顺序合成单词，最多提前 lookahead 个；调用者取出第 N 个单词发送时，
+     * 第 N+1 个已在合成。合成失败的单词只输出停顿。析构时停止合成并等待后台线程。
+     */
+    class Pipeline {
+    public:
+        /**
+         * @brief 构造并开始合成
+         * @param audio 单词音频
+         * @param words 单词
+         * @param pause_ms 单词间停顿（毫秒）
+         * @param lookahead 最多提前合成的单词数
+         */
+        Pipeline(WordAudio& audio, vector<string> words, int pause_ms, size_t lookahead = 2);
+
+        ~Pipeline();
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        /**
+         * @brief 取出下一段输出（第一段带占位长度的 WAV 文件头，之后每段为停顿 + 一个单词）
+         * @param body 追加输出内容
+         * @return 是否还有输出
+         */
+        bool next(Body& body);
+
+    private:
+        WordAudio& audio;               ///< 单词音频
+        vector<string> words;           ///< 单词
+        shared_ptr<const string> gap;   ///< 单词间的静音
+        size_t lookahead;               ///< 最多提前合成的单词数
+        size_t taken = 0;               ///< 已取出的单词数（只由调用者访问）
+
+        mutex ready_mutex;              ///< 保护以下成员
+        condition_variable changed;     ///< 合成完成、取出或停止时通知
+        deque<Body> ready;              ///< 已合成、等待取出的单词
+        bool stopping = false;          ///< 是否停止合成
+        thread producer;                ///< 合成线程
+
+        void run_producer();
+    };
+
+    static constexpr size_t MAX_WORD_LENGTH = 100;  ///< 单个单词的最大长度
+    static constexpr size_t MAX_WORDS = 200;        ///< 一个序列的最大单词数
+    static constexpr int MAX_PAUSE_MS = 5000;       ///< 单词间停顿的上限
+
+    /**
+     * @brief 构造函数
+     * @param pack 预先合成的音频包（采样率与引擎不同时不使用）
+     * @param speed 现场合成的语速（每分钟单词数）
+     * @param cache_entries 现场合成结果的缓存条数
+     */
+    WordAudio(const AudioPack& pack, int speed = 150, size_t cache_entries = 256);
+
+    WordAudio(const WordAudio&) = delete;
+    WordAudio& operator=(const WordAudio&) = delete;
+
+    /**
+     * @brief 获取输出采样率
+     */
+    int sample_rate() const;
+
+    /**
+     * @brief 查找已有的单词音频（音频包或缓存），不合成
+     * @param word 单词
+     * @param body 追加该单词的完整 WAV
+     * @return 是否找到
+     */
+    bool find(const string& word, Body& body);
+
+    /**
+     * @brief 获取单词音频，没有时现场合成（可能阻塞数十到数百毫秒）
+     * @param word 单词
+     * @param body 追加该单词的完整 WAV
+     * @return 是否成功
+     */
+    bool get(const string& word, Body& body);
+
+    /**
+     * @brief 拼接单词序列为一个 WAV，只使用已有的音频
+     * @param words 单词
+     * @param pause_ms 单词间停顿（毫秒）
+     * @param body 输出内容
+     * @return 全部单词都已有音频时返回 true，否则需要边合成边输出
+     */
+    bool find_sequence(const vector<string>& words, int pause_ms, Body& body);
+
+    /**
+     * @brief 获取单词的 PCM 片段，没有时现场合成（边合成边输出序列时使用）
+     * @param word 单词
+     * @param body 追加 PCM（不含 WAV 文件头）
+     * @return 是否成功
+     */
+    bool get_samples(const string& word, Body& body);
+
+    /**
+     * @brief 获取静音的 PCM
+     * @param milliseconds 时长
+     * @return 静音字节（同一时长共享一份）
+     */
+    shared_ptr<const string> silence(int milliseconds);
+
+    /**
+     * @brief 获取统计
+     * @return JSON格式的音频包命中、缓存命中与现场合成次数
+     */
+    json get_stats() const;
+
+    /**
+     * @brief 把请求中的单词列表拆分为单词（按空白与逗号分隔）
+     * @param text 单词列表
+     * @return 单词
+     */
+    static vector<string> split_words(const string& text);
+
+private:
+    const AudioPack* pack;              ///< 可用的音频包（不可用时为空）
+    SpeechEngine& engine;               ///< 语音合成引擎
+    int speed;                          ///< 现场合成的语速
+    size_t cache_entries;               ///< 缓存条数上限
+
+    /**
+     * @brief 缓存中的一段现场合成的音频
+     */
+    struct CachedClip {
+        shared_ptr<const string> wav;   ///< 完整的 WAV
+        uint64_t hash;                  ///< 内容哈希（放入缓存前计算）
+    };
+
+    mutable mutex cache_mutex;          ///< 保护以下三个成员
+    map<string, CachedClip> cache;      ///< 现场合成的音频
+    deque<string> cache_order;          ///< 缓存的插入顺序（先进先出淘汰）
+    map<int, shared_ptr<const string>> silences;    ///< 按时长缓存的静音
+
+    atomic<uint64_t> pack_hits{0};      ///< 音频包命中次数
+    atomic<uint64_t> cache_hits{0};     ///< 缓存命中次数
+    atomic<uint64_t> synthesized{0};    ///< 现场合成次数
+    atomic<uint64_t> failures{0};       ///< 合成失败次数
+
+    /**
+     * @brief 查找完整 WAV（音频包或缓存）及其内容哈希
+     */
+    bool lookup(const string& word, string_view& wav, shared_ptr<const string>& owner, uint64_t& hash);
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief word_reader 守护进程（word_reader --daemon）的客户端
+ *
+ * 通过 Unix 域套接字通信，每帧为 4 字节大端长度加 UTF-8 文本。请求为一条命令：
+ *
+ *     speak <文本>                  按当前语速朗读一段文本
+ *     batch <wpm> <ms> <单词...>    以 wpm（80-450）的语速依次朗读，单词间停顿 ms（0-5000）毫秒，
+ *                                   只作用于本批次
+ *     speed <wpm>                   设置默认语速
+ *     pause <ms>                    设置默认的单词间停顿
+ *     cancel             丢弃尚未朗读的内容
+ *     status             查询队列长度、语速与后端
+ *
+ * 守护进程排队后立即回复 "ok ..." 或 "error <原因>"，不等待播放结束。
+ * 连接保持打开，多次请求复用同一连接，断开后下次请求自动重连。
+ */
+class WordReaderClient {
+public:
+    static constexpr size_t MAX_FRAME = 64 * 1024;  ///< 单帧最大字节数
+
+    /**
+     * @brief 构造函数（第一次请求时才连接）
+     * @param socket_path 守护进程的套接字路径
+     */
+    explicit WordReaderClient(const string& socket_path);
+
+    /**
+     * @brief 析构函数，关闭连接
+     */
+    ~WordReaderClient();
+
+    WordReaderClient(const WordReaderClient&) = delete;
+    WordReaderClient& operator=(const WordReaderClient&) = delete;
+
+    /**
+     * @brief 发送命令并等待回复（多个线程同时调用时依次进行）
+     * @param command 命令
+     * @param reply 输出回复
+     * @return 是否收到回复（回复本身可能是 error）
+     */
+    bool request(const string& command, string& reply);
+
+    /**
+     * @brief 获取套接字路径
+     */
+    const string& path() const;
+
+    /**
+     * @brief 写入一帧
+     * @param fd 套接字
+     * @param payload 内容
+     * @return 是否成功
+     */
+    static bool write_frame(int fd, const string& payload);
+
+    /**
+     * @brief 读取一帧
+     * @param fd 套接字
+     * @param payload 输出内容
+     * @return 是否成功（对端关闭或帧过大时返回 false）
+     */
+    static bool read_frame(int fd, string& payload);
+
+private:
+    string socket_path;     ///< 套接字路径
+    mutex client_mutex;     ///< 串行化请求
+    int fd = -1;            ///< 当前连接
+
+    /**
+     * @brief 建立连接（调用者需持有 client_mutex）
+     */
+    bool connect_locked();
+
+    /**
+     * @brief 关闭连接（调用者需持有 client_mutex）
+     */
+    void close_locked();
+};
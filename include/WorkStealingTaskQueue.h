@@ -0,0 +1,158 @@
+#pragma once
+
+#include <httplib.h>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+using namespace std;
+
+/**
+ * @brief 基于工作窃取的 httplib 任务队列
+ *
+ * 每个工作线程有自己的双端队列，新连接放入两个候选队列中较短的一个；线程先从自己
+ * 队列的头部取，空了再从其他队列的尾部窃取。各队列的长度是原子计数，窃取时只给
+ * 非空的队列加锁。等待中的连接总数有上限，超出时 enqueue 返回 false，httplib 直接关闭该连接。
+ *
+ * 同时执行请求的线程数限制为 worker_count，名额用原子计数认领，取任务与执行都不经过
+ * 全局锁；只有没有任务或没有名额、需要睡眠与唤醒时才使用 idle_mutex。
+ * 慢处理（如外部词典查询）用 BlockingScope 包住阻塞部分，期间让出名额，由预先创建的
+ * 备用线程继续处理其他连接，最多补 spare_count 个，慢请求再多也不会让快请求排队。
+ */
+class WorkStealingTaskQueue : public httplib::TaskQueue {
+public:
+    /**
+     * @brief 慢处理区，作用域内当前工作线程不占用执行名额
+     *
+     * 不在本队列的工作线程上使用或嵌套使用时不起作用。
+     */
+    class BlockingScope {
+    public:
+        BlockingScope();
+        ~BlockingScope();
+        BlockingScope(const BlockingScope&) = delete;
+        BlockingScope& operator=(const BlockingScope&) = delete;
+
+    private:
+        WorkStealingTaskQueue* queue;
+    };
+
+    /**
+     * @brief 构造函数，启动全部工作线程
+     * @param worker_count 同时执行请求的线程数
+     * @param max_queued 等待处理的任务上限（0 表示不限）
+     * @param spare_count 备用线程数
+     */
+    WorkStealingTaskQueue(size_t worker_count, size_t max_queued, size_t spare_count);
+
+    ~WorkStealingTaskQueue() override;
+
+    /**
+     * @brief 放入一个任务（httplib 每接受一个连接调用一次）
+     * @param fn 任务
+     * @return 队列已满或已停止时返回 false
+     */
+    bool enqueue(function<void()> fn) override;
+
+    /**
+     * @brief 执行完已放入的任务后停止全部线程
+     */
+    void shutdown() override;
+
+    /**
+     * @brief 获取队列长度、排队时间、窃取次数等统计
+     * @return JSON格式的统计
+     */
+    json get_stats() const;
+
+private:
+    /**
+     * @brief 排队中的任务
+     */
+    struct Task {
+        function<void()> fn;                        ///< 任务
+        chrono::steady_clock::time_point enqueued;  ///< 放入时间
+    };
+
+    /**
+     * @brief 一个工作线程的本地队列，按缓存行对齐避免伪共享
+     */
+    struct alignas(64) LocalQueue {
+        mutex queue_mutex;          ///< 保护 tasks
+        deque<Task> tasks;          ///< 本地任务
+        atomic<size_t> size{0};     ///< tasks 的长度（不加锁读取，用于挑选与跳过空队列）
+    };
+
+    size_t worker_count;                    ///< 执行名额
+    size_t max_queued;                      ///< 排队上限
+    unique_ptr<LocalQueue[]> local_queues;  ///< 每个工作线程一个（备用线程没有，只窃取）
+    vector<thread> threads;                 ///< 工作线程与备用线程
+    atomic<size_t> next_queue{0};           ///< 下一次放入的候选队列
+
+    atomic<size_t> queued{0};               ///< 已接受但尚未被取出的任务数（用于排队上限）
+    atomic<size_t> ready{0};                ///< 已放入本地队列、尚未被取出的任务数（在本地队列锁内随放入增加）
+    atomic<size_t> active{0};               ///< 占用名额执行中的线程数
+    atomic<size_t> blocked{0};              ///< 处于慢处理区的线程数
+    atomic<size_t> sleeping{0};             ///< 正在睡眠或准备睡眠的线程数
+    atomic<bool> stopping{false};           ///< 是否正在停止
+
+    mutex idle_mutex;                       ///< 只用于睡眠与唤醒
+    condition_variable wakeup;              ///< 有任务且有名额、或停止时通知
+
+    atomic<uint64_t> enqueued_count{0};     ///< 放入的任务数
+    atomic<uint64_t> rejected_count{0};     ///< 因队列满拒绝的任务数
+    atomic<uint64_t> completed_count{0};    ///< 执行完的任务数
+    atomic<uint64_t> steal_count{0};        ///< 从其他队列窃取的次数
+    atomic<uint64_t> total_wait_us{0};      ///< 累计排队时间
+    atomic<uint64_t> max_wait_us{0};        ///< 最长排队时间
+    atomic<size_t> max_queue_length{0};     ///< 最大排队长度
+    atomic<size_t> max_blocked{0};          ///< 同时处于慢处理区的最大线程数
+
+    inline static thread_local WorkStealingTaskQueue* current_queue = nullptr; ///< 当前线程所属的队列
+
+    /**
+     * @brief 工作线程主循环
+     * @param index 线程下标，小于 worker_count 的有本地队列
+     */
+    void run_worker(size_t index);
+
+    /**
+     * @brief 取出一个任务：先取本地队列头部，再窃取其他非空队列的尾部
+     */
+    bool take(size_t index, Task& task);
+
+    /**
+     * @brief 认领一个执行名额
+     * @return 名额已满时返回 false
+     */
+    bool claim_slot();
+
+    /**
+     * @brief 归还执行名额，还有任务时唤醒一个睡眠的线程
+     */
+    void release_slot();
+
+    /**
+     * @brief 睡眠到有任务且有名额、或停止
+     * @return 停止且没有剩余任务时返回 false
+     */
+    bool wait_for_work();
+
+    /**
+     * @brief 有线程在睡眠时唤醒其中一个
+     */
+    void notify_sleeper();
+
+    void begin_blocking();
+    void end_blocking();
+};
@@ -21,9 +21,17 @@ fi
 
 echo "✓ 构建环境检查完成"
 
+# 检查 libespeak-ng（找到则在进程内合成语音，否则运行时回退到 espeak --stdout）
+ESPEAK_FLAGS=""
+if pkg-config --exists espeak-ng 2>/dev/null; then
+    echo "✓ 检测到 libespeak-ng，使用进程内合成"
+    ESPEAK_FLAGS="-DWORD_APP_HAVE_ESPEAK_NG $(pkg-config --cflags --libs espeak-ng)"
+fi
+
 # 编译C++程序
 echo "编译C++程序..."
-g++ -std=c++11 -pthread -o word_reader word_reader.cpp
+g++ -std=c++17 -pthread -I../include -o word_reader word_reader.cpp \
+    ../src/SpeechEngine.cpp ../src/AudioSink.cpp ../src/WordReaderClient.cpp $ESPEAK_FLAGS
 
 if [ $? -eq 0 ]; then
     echo "✓ C++程序编译成功"
@@ -38,13 +46,16 @@ chmod +x server.py
 
 # 检查TTS引擎
 echo "检查TTS引擎..."
-if command -v espeak &> /dev/null; then
+if [ -n "$ESPEAK_FLAGS" ]; then
+    echo "✓ 使用 libespeak-ng"
+elif command -v espeak-ng &> /dev/null || command -v espeak &> /dev/null; then
     echo "✓ 检测到 espeak"
 elif command -v festival &> /dev/null; then
     echo "✓ 检测到 festival"
 else
     echo "⚠ 警告: 未检测到TTS引擎"
-    echo "建议安装 espeak: sudo apt-get install espeak"
+    echo "建议安装 espeak-ng: sudo apt-get install espeak-ng libespeak-ng-dev"
+    echo "或安装 espeak: sudo apt-get install espeak"
     echo "或安装 festival: sudo apt-get install festival"
 fi
 
@@ -54,3 +65,4 @@ echo "运行方式："
 echo "1. 启动服务器: ./run.sh"
 echo "2. 访问网页: http://localhost:8080"
 echo "3. 或命令行使用: ./word_reader \"hello world apple\""
+echo "4. 或常驻运行: ./word_reader --daemon [/tmp/word_reader.sock]"
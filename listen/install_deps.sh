@@ -17,7 +17,8 @@ if [ -f /etc/debian_version ]; then
     sudo apt-get install -y python3
     
     echo "安装TTS引擎..."
-    sudo apt-get install -y espeak espeak-data
+    sudo apt-get install -y espeak espeak-data alsa-utils
+    sudo apt-get install -y libespeak-ng-dev || echo "⚠ 未安装 libespeak-ng-dev，将回退到 espeak 程序"
     
     echo "✓ 依赖安装完成"
     
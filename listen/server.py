@@ -11,6 +11,59 @@ import urllib.parse
 import os
 import threading
 import time
+import socket
+import struct
+
+# word_reader --daemon 的套接字，守护进程运行时不再为每个请求启动 word_reader
+READER_SOCKET = os.environ.get('WORD_READER_SOCKET', '/tmp/word_reader.sock')
+
+
+class WordReaderClient:
+    """word_reader 守护进程的客户端（协议见 include/WordReaderClient.h）"""
+
+    def __init__(self, path):
+        self.path = path
+        self.sock = None
+        self.lock = threading.Lock()
+
+    def request(self, command):
+        """发送命令并返回回复，守护进程不可用时返回 None"""
+        with self.lock:
+            # 复用的连接可能已被守护进程重启断开，失败时重连一次
+            for _ in range(2):
+                reused = self.sock is not None
+                try:
+                    if self.sock is None:
+                        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                        sock.settimeout(2)
+                        sock.connect(self.path)
+                        self.sock = sock
+                    payload = command.encode('utf-8')
+                    self.sock.sendall(struct.pack('>I', len(payload)) + payload)
+                    size = struct.unpack('>I', self._recv_exact(4))[0]
+                    return self._recv_exact(size).decode('utf-8')
+                except OSError:
+                    self.close()
+                    if not reused:
+                        break
+            return None
+
+    def close(self):
+        if self.sock is not None:
+            self.sock.close()
+            self.sock = None
+
+    def _recv_exact(self, size):
+        data = b''
+        while len(data) < size:
+            chunk = self.sock.recv(size - len(data))
+            if not chunk:
+                raise ConnectionError("word_reader daemon closed the connection")
+            data += chunk
+        return data
+
+
+reader_client = WordReaderClient(READER_SOCKET)
 
 class WordReaderHandler(http.server.SimpleHTTPRequestHandler):
     def __init__(self, *args, **kwargs):
@@ -37,6 +90,15 @@ class WordReaderHandler(http.server.SimpleHTTPRequestHandler):
                 self.send_error(400, "No word provided")
                 return
             
+            # 优先交给常驻的 word_reader 守护进程
+            reply = reader_client.request('speak ' + word)
+            if reply is not None:
+                if reply.startswith('ok'):
+                    self.send_json({"status": "success", "message": f"Spoke word: {word}"})
+                else:
+                    self.send_json({"status": "error", "message": reply}, 400)
+                return
+            
             # 调用C++程序朗读单词
             result = subprocess.run(
                 ['/opt/listen/word_reader', word],
@@ -67,13 +129,26 @@ class WordReaderHandler(http.server.SimpleHTTPRequestHandler):
             data = json.loads(post_data.decode('utf-8'))
             
             text = data.get('text', '').strip()
-            speed = data.get('speed', 150)
-            pause = data.get('pause', 800)
+            try:
+                speed = int(data.get('speed', 150))
+                pause = int(data.get('pause', 800))
+            except (TypeError, ValueError):
+                self.send_json({"status": "error", "message": "speed and pause must be integers"}, 400)
+                return
             
             if not text:
                 self.send_error(400, "No text provided")
                 return
             
+            # 语速与停顿随批次发送，并发的请求不会互相改掉对方的设置；守护进程排队后立即回复
+            reply = reader_client.request(f'batch {speed} {pause} {text}')
+            if reply is not None:
+                if reply.startswith('ok'):
+                    self.send_json({"status": "success", "message": "Started speaking"})
+                else:
+                    self.send_json({"status": "error", "message": reply}, 400)
+                return
+            
             # 在后台线程中执行朗读，避免阻塞HTTP响应
             def speak_in_background():
                 try:
@@ -100,6 +175,12 @@ class WordReaderHandler(http.server.SimpleHTTPRequestHandler):
         except Exception as e:
             self.send_error(500, f"Internal server error: {str(e)}")
 
+    def send_json(self, response, status=200):
+        self.send_response(status)
+        self.send_header('Content-Type', 'application/json')
+        self.end_headers()
+        self.wfile.write(json.dumps(response).encode('utf-8'))
+
     def do_OPTIONS(self):
         """处理CORS预检请求"""
         self.send_response(200)
@@ -127,7 +208,7 @@ def main():
     
     if not os.path.exists(cpp_program):
         print(f"警告: C++程序 {cpp_program} 不存在")
-        print("请先编译C++程序: g++ -o word_reader word_reader.cpp")
+        print("请先编译C++程序: ./build.sh")
     
     # 检查TTS引擎
     tts_available = False
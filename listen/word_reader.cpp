@@ -7,23 +7,59 @@
 #include <chrono>
 #include <algorithm>
 #include <cctype>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "SpeechEngine.h"
+#include "AudioSink.h"
+#include "WordReaderClient.h"
+
+extern char** environ;
+
+// 在 PATH 中查找可执行程序，找不到返回空串
+static std::string findProgram(const std::string& name) {
+    const char* path = getenv("PATH");
+    std::stringstream dirs(path ? path : "/usr/bin:/bin");
+    std::string dir;
+    while (std::getline(dirs, dir, ':')) {
+        std::string candidate = (dir.empty() ? "." : dir) + "/" + name;
+        if (access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return "";
+}
 
 class WordReader {
 private:
+    SpeechEngine& engine;   // 进程内语音合成（libespeak-ng 或 espeak --stdout）
+    AudioSink sink;         // 常驻的 aplay，所有单词写入同一个播放器
     std::string tts_command;
-    int speed;
-    int pause_duration; // milliseconds between words
+    std::string festival_program;       // 没有 espeak 时的后备（festival 的完整路径）
+    std::atomic<int> speed;             // 守护进程中可由其他线程修改
+    std::atomic<int> pause_duration;    // milliseconds between words
     
 public:
     WordReader(int speech_speed = 150, int word_pause = 800) 
-        : speed(speech_speed), pause_duration(word_pause) {
+        : engine(SpeechEngine::instance()), sink(engine.sample_rate()),
+          speed(speech_speed), pause_duration(word_pause) {
         // 检查可用的TTS引擎
-        if (system("which espeak > /dev/null 2>&1") == 0) {
-            tts_command = "espeak";
-        } else if (system("which festival > /dev/null 2>&1") == 0) {
+        if (engine.available()) {
+            tts_command = engine.backend();
+        } else if (!(festival_program = findProgram("festival")).empty()) {
             tts_command = "festival --tts";
         } else {
-            std::cerr << "Warning: No TTS engine found. Please install espeak or festival." << std::endl;
+            std::cerr << "Warning: No TTS engine found. Please install espeak-ng or festival." << std::endl;
             tts_command = "echo"; // fallback for testing
         }
     }
@@ -53,17 +89,84 @@ public:
     
     // 朗读单个单词
     void speakWord(const std::string& word) {
-        std::string command;
+        speakWord(word, speed);
+    }
+    
+    // 按指定语速朗读单个单词（守护进程中每个批次可以有自己的语速）
+    void speakWord(const std::string& word, int word_speed) {
+        if (engine.available()) {
+            // 合成到内存后写入播放器，不为每个单词启动进程
+            std::vector<int16_t> samples;
+            if (!engine.synthesize(word, word_speed, samples) || !sink.play(samples)) {
+                std::cerr << "Failed to speak: " << word << std::endl;
+            }
+            return;
+        }
         
-        if (tts_command == "espeak") {
-            command = "espeak -s " + std::to_string(speed) + " \"" + word + "\"";
-        } else if (tts_command.find("festival") != std::string::npos) {
-            command = "echo \"" + word + "\" | festival --tts";
-        } else {
-            command = "echo \"Speaking: " + word + "\"";
+        if (festival_program.empty()) {
+            std::cout << "Speaking: " << word << std::endl;
+            return;
+        }
+        if (!speakWithFestival(word)) {
+            std::cerr << "Failed to speak: " << word << std::endl;
+        }
+    }
+    
+    // 启动 festival --tts，文本从标准输入传入，不经过 shell
+    bool speakWithFestival(const std::string& text) {
+        int input[2];
+        if (pipe2(input, O_CLOEXEC) != 0) {
+            return false;
+        }
+        
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, input[0], STDIN_FILENO);
+        char* argv[] = {
+            const_cast<char*>(festival_program.c_str()),
+            const_cast<char*>("--tts"),
+            nullptr
+        };
+        pid_t pid;
+        int error = posix_spawn(&pid, festival_program.c_str(), &actions, nullptr, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(input[0]);
+        if (error != 0) {
+            std::cerr << "Error: Cannot start " << festival_program << ": " << strerror(error) << std::endl;
+            close(input[1]);
+            return false;
         }
         
-        system(command.c_str());
+        // 单词远小于管道缓冲区，一次写完；关闭后 festival 读到结尾开始朗读
+        std::string line = text + "\n";
+        bool written = write(input[1], line.data(), line.size()) == (ssize_t)line.size();
+        close(input[1]);
+        
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        return written && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    
+    // 单词间暂停：使用内置引擎时写入静音，与朗读按音频时间对齐
+    void pause() {
+        pause(pause_duration);
+    }
+    
+    void pause(int pause_ms) {
+        if (engine.available()) {
+            sink.play_silence(pause_ms);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(pause_ms));
+        }
+    }
+    
+    static bool validSpeed(int value) {
+        return value >= 80 && value <= 450;
+    }
+    
+    static bool validPause(int value) {
+        return value >= 0 && value <= 5000;
     }
     
     // 依次朗读所有单词
@@ -78,7 +181,7 @@ public:
             
             // 单词间暂停
             if (i < words.size() - 1) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(pause_duration));
+                pause();
             }
         }
         
@@ -94,6 +197,200 @@ public:
     void setPauseDuration(int pause_ms) {
         pause_duration = pause_ms;
     }
+    
+    int getSpeed() const {
+        return speed;
+    }
+    
+    int getPauseDuration() const {
+        return pause_duration;
+    }
+    
+    const std::string& getBackend() const {
+        return tts_command;
+    }
+};
+
+// 守护进程：引擎只检测和初始化一次，通过 Unix 域套接字接收命令（协议见 WordReaderClient.h）
+class ReaderDaemon {
+private:
+    // 播放队列中的一项（语速与停顿在入队时确定，之后修改全局设置不影响已排队的内容）
+    struct Item {
+        std::string text;
+        int speed;
+        int pause_after;    // 朗读后的停顿（毫秒），0 表示不停顿
+    };
+    
+    WordReader& reader;
+    std::string socket_path;
+    std::mutex queue_mutex;
+    std::condition_variable queue_ready;
+    std::deque<Item> queue;
+    std::thread player;
+    
+    // 播放线程：依次朗读队列中的内容，cancel 只丢弃尚未开始的部分
+    void runPlayer() {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        while (true) {
+            queue_ready.wait(lock, [this] { return !queue.empty(); });
+            Item item = queue.front();
+            queue.pop_front();
+            lock.unlock();
+            
+            reader.speakWord(item.text, item.speed);
+            if (item.pause_after > 0) {
+                reader.pause(item.pause_after);
+            }
+            lock.lock();
+        }
+    }
+    
+    void enqueue(std::vector<Item> items) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.insert(queue.end(), items.begin(), items.end());
+        }
+        queue_ready.notify_one();
+    }
+    
+    // 执行一条命令，返回回复
+    std::string handle(const std::string& request) {
+        size_t space = request.find(' ');
+        std::string command = request.substr(0, space);
+        std::string argument = space == std::string::npos ? "" : request.substr(space + 1);
+        
+        if (command == "speak") {
+            // 与 batch 一样只保留单词（去掉标点），原始文本不会传给任何外部程序
+            std::vector<std::string> words = reader.splitWords(argument);
+            if (words.empty()) {
+                return "error no text";
+            }
+            std::string text = words[0];
+            for (size_t i = 1; i < words.size(); i++) {
+                text += " " + words[i];
+            }
+            enqueue({{text, reader.getSpeed(), 0}});
+            return "ok queued";
+        }
+        if (command == "batch") {
+            // batch <wpm> <ms> <单词...>：语速与停顿随批次携带，不修改全局设置
+            std::istringstream fields(argument);
+            int batch_speed = 0;
+            int batch_pause = -1;
+            if (!(fields >> batch_speed) || !WordReader::validSpeed(batch_speed)) {
+                return "error invalid speed";
+            }
+            if (!(fields >> batch_pause) || !WordReader::validPause(batch_pause)) {
+                return "error invalid pause";
+            }
+            std::string text;
+            std::getline(fields, text);
+            std::vector<std::string> words = reader.splitWords(text);
+            if (words.empty()) {
+                return "error no words";
+            }
+            std::vector<Item> items;
+            for (size_t i = 0; i < words.size(); i++) {
+                items.push_back({words[i], batch_speed, i + 1 < words.size() ? batch_pause : 0});
+            }
+            enqueue(std::move(items));
+            return "ok queued " + std::to_string(words.size());
+        }
+        if (command == "speed" || command == "pause") {
+            int value = atoi(argument.c_str());
+            if (command == "speed" && WordReader::validSpeed(value)) {
+                reader.setSpeed(value);
+            } else if (command == "pause" && WordReader::validPause(value)) {
+                reader.setPauseDuration(value);
+            } else {
+                return "error invalid " + command;
+            }
+            return "ok " + command + " " + std::to_string(value);
+        }
+        if (command == "cancel") {
+            size_t dropped;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                dropped = queue.size();
+                queue.clear();
+            }
+            return "ok cancelled " + std::to_string(dropped);
+        }
+        if (command == "status") {
+            size_t queued;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                queued = queue.size();
+            }
+            return "ok queued=" + std::to_string(queued) + " speed=" + std::to_string(reader.getSpeed()) +
+                   " pause=" + std::to_string(reader.getPauseDuration()) + " backend=" + reader.getBackend();
+        }
+        return "error unknown command " + command;
+    }
+    
+    // 处理一个连接上的所有请求
+    void serve(int client) {
+        std::string request;
+        while (WordReaderClient::read_frame(client, request)) {
+            if (!WordReaderClient::write_frame(client, handle(request))) {
+                break;
+            }
+        }
+        close(client);
+    }
+    
+public:
+    ReaderDaemon(WordReader& word_reader, const std::string& path)
+        : reader(word_reader), socket_path(path) {}
+    
+    // 监听套接字并处理请求（不返回，SIGINT/SIGTERM 时删除套接字文件后退出）
+    int run() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Error: Socket path too long: " << socket_path << std::endl;
+            return 1;
+        }
+        strcpy(address.sun_path, socket_path.c_str());
+        
+        int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        unlink(socket_path.c_str());
+        // 只允许本用户连接
+        mode_t old_mask = umask(0077);
+        bool bound = server >= 0 && bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        umask(old_mask);
+        if (!bound || listen(server, 16) != 0) {
+            std::cerr << "Error: Cannot listen on " << socket_path << ": " << strerror(errno) << std::endl;
+            return 1;
+        }
+        
+        static std::string cleanup_path;
+        cleanup_path = socket_path;
+        auto on_signal = [](int) {
+            unlink(cleanup_path.c_str());
+            _exit(0);
+        };
+        signal(SIGINT, on_signal);
+        signal(SIGTERM, on_signal);
+        
+        player = std::thread(&ReaderDaemon::runPlayer, this);
+        std::cout << "word_reader daemon listening on " << socket_path << " (" << reader.getBackend() << ")" << std::endl;
+        
+        while (true) {
+            int client = accept4(server, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                std::cerr << "Error: accept failed: " << strerror(errno) << std::endl;
+                break;
+            }
+            std::thread(&ReaderDaemon::serve, this, client).detach();
+        }
+        close(server);
+        unlink(socket_path.c_str());
+        _exit(1);
+    }
 };
 
 // HTTP服务器处理函数
@@ -110,7 +407,13 @@ int main(int argc, char* argv[]) {
     
     if (argc > 1) {
         // 命令行模式
-        if (std::string(argv[1]) == "--server") {
+        if (std::string(argv[1]) == "--daemon") {
+            // 常驻模式：套接字路径取参数、环境变量 WORD_READER_SOCKET 或默认值
+            const char* env_path = getenv("WORD_READER_SOCKET");
+            std::string path = argc > 2 ? argv[2] : (env_path ? env_path : "/tmp/word_reader.sock");
+            ReaderDaemon daemon(reader, path);
+            return daemon.run();
+        } else if (std::string(argv[1]) == "--server") {
             handleHttpRequest();
             
             std::cout << "HTTP server started. Visit http://localhost:8080" << std::endl;
@@ -0,0 +1,176 @@
+#include "AudioPack.h"
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+template <typename T>
+void put(string& out, T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T get(const char* in, size_t offset) {
+    T value;
+    memcpy(&value, in + offset, sizeof(T));
+    return value;
+}
+
+}
+
+AudioPack::AudioPack(const string& path) {
+    open(path);
+}
+
+AudioPack::~AudioPack() {
+    close();
+}
+
+void AudioPack::close() {
+    clips.clear();
+    if (data) {
+        munmap(const_cast<char*>(data), length);
+        data = nullptr;
+        length = 0;
+    }
+}
+
+bool AudioPack::open(const string& path) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < HEADER_SIZE) {
+        cerr << "Error: Invalid audio pack " << path << endl;
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        cerr << "Error: Cannot map audio pack " << path << endl;
+        return false;
+    }
+    data = static_cast<const char*>(mapped);
+    length = info.st_size;
+    
+    uint16_t version = get<uint16_t>(data, 4);
+    uint16_t entry_size = get<uint16_t>(data, 6);
+    uint32_t count = get<uint32_t>(data, 8);
+    uint64_t strings_offset = get<uint64_t>(data, 16);
+    uint64_t clips_offset = get<uint64_t>(data, 24);
+    rate = get<uint32_t>(data, 12);
+    size_t min_entry_size = version == 1 ? V1_ENTRY_SIZE : ENTRY_SIZE;
+    if (memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || version == 0 || version > FORMAT_VERSION || entry_size < min_entry_size ||
+        HEADER_SIZE + (uint64_t)count * entry_size > strings_offset ||
+        strings_offset > clips_offset || clips_offset > length) {
+        cerr << "Error: Invalid audio pack " << path << endl;
+        close();
+        return false;
+    }
+    
+    clips.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        size_t entry = HEADER_SIZE + (size_t)i * entry_size;
+        uint64_t clip_offset = get<uint64_t>(data, entry);
+        uint32_t clip_size = get<uint32_t>(data, entry + 8);
+        uint32_t word_offset = get<uint32_t>(data, entry + 12);
+        uint32_t word_length = get<uint32_t>(data, entry + 16);
+        if (strings_offset + word_offset + word_length > clips_offset ||
+            clip_offset < clips_offset || clip_offset % CLIP_ALIGNMENT != 0 || clip_offset + clip_size > length ||
+            clip_size < WAV_HEADER_SIZE || memcmp(data + clip_offset, "RIFF", 4) != 0 || memcmp(data + clip_offset + 36, "data", 4) != 0) {
+            cerr << "Error: Corrupt entry " << i << " in audio pack " << path << endl;
+            close();
+            return false;
+        }
+        string_view wav(data + clip_offset, clip_size);
+        // 版本1没有存哈希，打开时计算一次（会读入全部音频，重新生成音频包可避免）
+        uint64_t hash = version == 1 ? content_hash(wav) : get<uint64_t>(data, entry + 24);
+        clips.emplace(string_view(data + strings_offset + word_offset, word_length), Clip{wav, hash});
+    }
+    return true;
+}
+
+bool AudioPack::is_open() const {
+    return data != nullptr;
+}
+
+string_view AudioPack::find(const string& word) const {
+    uint64_t hash;
+    return find(word, hash);
+}
+
+string_view AudioPack::find(const string& word, uint64_t& hash) const {
+    auto it = clips.find(word);
+    if (it == clips.end()) {
+        return string_view();
+    }
+    hash = it->second.hash;
+    return it->second.wav;
+}
+
+size_t AudioPack::size() const {
+    return clips.size();
+}
+
+int AudioPack::sample_rate() const {
+    return rate;
+}
+
+string AudioPack::encode(const vector<string>& words, const vector<string>& clips, int sample_rate) {
+    string strings;
+    for (const string& word : words) {
+        strings += word;
+    }
+    
+    uint64_t strings_offset = HEADER_SIZE + words.size() * ENTRY_SIZE;
+    // 每段音频按 8 字节对齐，PCM 可以直接按 int16_t 读取
+    auto aligned = [](uint64_t offset) { return (offset + CLIP_ALIGNMENT - 1) & ~(uint64_t)(CLIP_ALIGNMENT - 1); };
+    uint64_t clips_offset = aligned(strings_offset + strings.size());
+    
+    string out;
+    out.append(MAGIC, sizeof(MAGIC));
+    put<uint16_t>(out, FORMAT_VERSION);
+    put<uint16_t>(out, ENTRY_SIZE);
+    put<uint32_t>(out, words.size());
+    put<uint32_t>(out, sample_rate);
+    put<uint64_t>(out, strings_offset);
+    put<uint64_t>(out, clips_offset);
+    
+    uint64_t clip_offset = clips_offset;
+    uint32_t word_offset = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+        put<uint64_t>(out, clip_offset);
+        put<uint32_t>(out, clips[i].size());
+        put<uint32_t>(out, word_offset);
+        put<uint32_t>(out, words[i].size());
+        put<uint32_t>(out, 0);
+        put<uint64_t>(out, content_hash(clips[i]));
+        clip_offset = aligned(clip_offset + clips[i].size());
+        word_offset += words[i].size();
+    }
+    
+    out += strings;
+    for (const string& clip : clips) {
+        out.resize(aligned(out.size()), '\0');
+        out += clip;
+    }
+    return out;
+}
+
+uint64_t AudioPack::content_hash(string_view bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : bytes) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,154 @@
+#include "AudioSink.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+namespace {
+
+/**
+ * @brief 写管道期间屏蔽本线程的 SIGPIPE，不改变进程的信号处理方式
+ *
+ * 管道不能像套接字那样用 MSG_NOSIGNAL。aplay 退出后 write 返回 EPIPE（已写入一部分时
+ * 返回写入的字节数，但同样产生 SIGPIPE），信号在屏蔽期间挂起，恢复屏蔽字前把它取走。
+ */
+class SigpipeBlock {
+public:
+    SigpipeBlock() {
+        sigemptyset(&sigpipe);
+        sigaddset(&sigpipe, SIGPIPE);
+        // 已经挂起的 SIGPIPE 不属于本次写入，不能替别人取走
+        sigset_t pending;
+        sigpending(&pending);
+        was_pending = sigismember(&pending, SIGPIPE) == 1;
+        pthread_sigmask(SIG_BLOCK, &sigpipe, &previous);
+    }
+
+    ~SigpipeBlock() {
+        int error = errno;
+        sigset_t pending;
+        if (!was_pending && sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE) == 1) {
+            timespec zero = {0, 0};
+            while (sigtimedwait(&sigpipe, nullptr, &zero) < 0 && errno == EINTR) {
+            }
+        }
+        pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+        errno = error;
+    }
+
+    SigpipeBlock(const SigpipeBlock&) = delete;
+    SigpipeBlock& operator=(const SigpipeBlock&) = delete;
+
+private:
+    sigset_t sigpipe;
+    sigset_t previous;
+    bool was_pending;
+};
+
+}
+
+AudioSink::AudioSink(int sample_rate) : sample_rate(sample_rate) {}
+
+AudioSink::~AudioSink() {
+    lock_guard<mutex> lock(sink_mutex);
+    close_player();
+}
+
+bool AudioSink::start() {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return false;
+    }
+    
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+    
+    string rate_arg = to_string(sample_rate);
+    vector<char*> argv = {
+        const_cast<char*>("aplay"), const_cast<char*>("-q"),
+        const_cast<char*>("-t"), const_cast<char*>("raw"),
+        const_cast<char*>("-f"), const_cast<char*>("S16_LE"),
+        const_cast<char*>("-c"), const_cast<char*>("1"),
+        const_cast<char*>("-r"), const_cast<char*>(rate_arg.c_str()),
+        const_cast<char*>("-"),
+        nullptr
+    };
+    int error = posix_spawnp(&pid, "aplay", &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[0]);
+    if (error != 0) {
+        cerr << "Error: Cannot start aplay: " << strerror(error) << endl;
+        close(fds[1]);
+        pid = -1;
+        return false;
+    }
+    fd = fds[1];
+    return true;
+}
+
+void AudioSink::close_player() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (pid > 0) {
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        pid = -1;
+    }
+}
+
+bool AudioSink::write_locked(const char* data, size_t size) {
+    bool restarted = false;
+    size_t written = 0;
+    while (written < size) {
+        if (fd < 0 && !start()) {
+            return false;
+        }
+        ssize_t count;
+        {
+            SigpipeBlock block;
+            count = write(fd, data + written, size - written);
+        }
+        if (count > 0) {
+            written += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        
+        // 播放器已退出（例如音频设备被占用后恢复），重启一次继续写剩余部分
+        close_player();
+        if (restarted) {
+            return false;
+        }
+        restarted = true;
+    }
+    return true;
+}
+
+bool AudioSink::play(const vector<int16_t>& samples) {
+    return play(samples.data(), samples.size());
+}
+
+bool AudioSink::play(const int16_t* samples, size_t count) {
+    lock_guard<mutex> lock(sink_mutex);
+    return write_locked(reinterpret_cast<const char*>(samples), count * sizeof(int16_t));
+}
+
+bool AudioSink::play_silence(int milliseconds) {
+    vector<int16_t> silence((size_t)sample_rate * max(0, milliseconds) / 1000, 0);
+    return play(silence);
+}
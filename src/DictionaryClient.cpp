@@ -0,0 +1,132 @@
+#include "DictionaryClient.h"
+#include <httplib.h>
+#include <chrono>
+#include <cctype>
+
+DictionaryClient::Options::Options() : base_url("https://fanyi.youdao.com") {
+}
+
+DictionaryClient::DictionaryClient(const Options& options) : options(options) {
+    this->options.max_connections = max<size_t>(1, options.max_connections);
+}
+
+DictionaryClient::~DictionaryClient() = default;
+
+unique_ptr<httplib::Client> DictionaryClient::acquire() {
+    unique_lock<mutex> lock(pool_mutex);
+    if (idle.empty() && open_connections >= options.max_connections) {
+        waits++;
+        // 最多等一个连接超时，等不到说明上游已经很慢，直接失败让调用者用本地词典
+        bool available = released.wait_for(lock, chrono::milliseconds(options.connect_timeout_ms), [this] {
+            return !idle.empty() || open_connections < options.max_connections;
+        });
+        if (!available) {
+            return nullptr;
+        }
+    }
+    
+    if (!idle.empty()) {
+        unique_ptr<httplib::Client> client = move(idle.back());
+        idle.pop_back();
+        return client;
+    }
+    open_connections++;
+    lock.unlock();
+    
+    auto client = make_unique<httplib::Client>(options.base_url);
+    client->set_keep_alive(true);
+    client->set_follow_location(true);
+    client->set_connection_timeout(options.connect_timeout_ms / 1000, options.connect_timeout_ms % 1000 * 1000);
+    client->set_read_timeout(options.read_timeout_ms / 1000, options.read_timeout_ms % 1000 * 1000);
+    client->set_write_timeout(options.read_timeout_ms / 1000, options.read_timeout_ms % 1000 * 1000);
+    client->set_default_headers({
+        {"Accept", "application/json"},
+        {"User-Agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36"}
+    });
+    return client;
+}
+
+void DictionaryClient::release(unique_ptr<httplib::Client> client) {
+    {
+        lock_guard<mutex> lock(pool_mutex);
+        if (client) {
+            idle.push_back(move(client));
+        } else {
+            open_connections--;
+        }
+    }
+    released.notify_one();
+}
+
+bool DictionaryClient::get(const string& path, string& body, string& error) {
+    auto started = chrono::steady_clock::now();
+    requests++;
+    
+    unique_ptr<httplib::Client> client = acquire();
+    if (!client) {
+        failures++;
+        error = "Dictionary connection pool exhausted";
+        return false;
+    }
+    if (!client->is_valid()) {
+        release(nullptr);
+        failures++;
+        error = "Invalid dictionary URL " + options.base_url + " (https requires OpenSSL support)";
+        return false;
+    }
+    
+    auto result = client->Get(path);
+    bool ok = false;
+    if (!result) {
+        error = "Network request failed: " + httplib::to_string(result.error());
+        // 出错的连接不再复用，下次新建
+        client.reset();
+    } else if (result->status < 200 || result->status >= 300) {
+        error = "HTTP status " + to_string(result->status);
+    } else {
+        body = result->body;
+        ok = true;
+    }
+    release(move(client));
+    
+    if (!ok) {
+        failures++;
+    }
+    total_us += chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started).count();
+    return ok;
+}
+
+json DictionaryClient::get_stats() const {
+    size_t idle_connections, open;
+    {
+        lock_guard<mutex> lock(pool_mutex);
+        idle_connections = idle.size();
+        open = open_connections;
+    }
+    uint64_t count = requests.load();
+    return {
+        {"base_url", options.base_url},
+        {"max_connections", options.max_connections},
+        {"open_connections", open},
+        {"idle_connections", idle_connections},
+        {"requests", count},
+        {"failures", failures.load()},
+        {"waits", waits.load()},
+        {"avg_ms", count > 0 ? total_us.load() / 1000.0 / count : 0.0}
+    };
+}
+
+string DictionaryClient::url_encode(const string& value) {
+    static const char hex[] = "0123456789ABCDEF";
+    string encoded;
+    for (unsigned char c : value) {
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            encoded += c;
+        } else {
+            encoded += '%';
+            encoded += hex[c >> 4];
+            encoded += hex[c & 15];
+        }
+    }
+    return encoded;
+}
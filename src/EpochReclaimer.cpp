@@ -0,0 +1,115 @@
+#include "EpochReclaimer.h"
+#include <limits>
+
+/**
+ * @brief 每个读线程一个纪元槽，按缓存行对齐避免伪共享
+ */
+struct alignas(64) EpochSlot {
+    atomic<uint64_t> epoch{0};      ///< 读者进入时看到的全局纪元，0 表示不在临界区
+    atomic<bool> in_use{false};     ///< 是否已被某个线程占用
+    unsigned depth = 0;             ///< 嵌套深度（只由所属线程访问）
+    EpochSlot* next = nullptr;           ///< 链表中的下一个槽
+};
+
+/**
+ * @brief 线程退出时归还槽
+ */
+struct SlotRegistration {
+    EpochSlot* slot = nullptr;
+
+    ~SlotRegistration() {
+        if (slot) {
+            slot->epoch.store(0);
+            slot->in_use.store(false, memory_order_release);
+        }
+    }
+};
+
+EpochReclaimer& EpochReclaimer::instance() {
+    static EpochReclaimer reclaimer;
+    return reclaimer;
+}
+
+EpochReclaimer::~EpochReclaimer() {
+    // 进程退出时已没有读者
+    for (const Retired& item : retired) {
+        item.deleter(item.object);
+    }
+    EpochSlot* slot = slots.load();
+    while (slot) {
+        EpochSlot* next = slot->next;
+        delete slot;
+        slot = next;
+    }
+}
+
+EpochSlot* EpochReclaimer::local_slot() {
+    thread_local SlotRegistration registration;
+    if (registration.slot) {
+        return registration.slot;
+    }
+
+    // 先复用已退出线程的槽
+    for (EpochSlot* slot = slots.load(); slot; slot = slot->next) {
+        bool expected = false;
+        if (!slot->in_use.load(memory_order_relaxed) &&
+            slot->in_use.compare_exchange_strong(expected, true, memory_order_acquire)) {
+            registration.slot = slot;
+            return slot;
+        }
+    }
+
+    EpochSlot* slot = new EpochSlot();
+    slot->in_use.store(true, memory_order_relaxed);
+    slot->next = slots.load();
+    while (!slots.compare_exchange_weak(slot->next, slot)) {
+    }
+    registration.slot = slot;
+    return slot;
+}
+
+EpochReclaimer::Guard::Guard(EpochReclaimer& reclaimer) : slot(reclaimer.local_slot()) {
+    if (slot->depth++ == 0) {
+        slot->epoch.store(reclaimer.global_epoch.load());
+    }
+}
+
+EpochReclaimer::Guard::~Guard() {
+    if (--slot->depth == 0) {
+        slot->epoch.store(0);
+    }
+}
+
+void EpochReclaimer::retire(const void* object, void (*deleter)(const void*)) {
+    // 指针已被替换，递增前的纪元之后进入的读者不可能再读到旧对象
+    uint64_t epoch = global_epoch.fetch_add(1);
+
+    lock_guard<mutex> lock(retired_mutex);
+    retired.push_back({epoch, object, deleter});
+    reclaim();
+}
+
+void EpochReclaimer::reclaim() {
+    uint64_t min_active = numeric_limits<uint64_t>::max();
+    for (EpochSlot* slot = slots.load(); slot; slot = slot->next) {
+        uint64_t epoch = slot->epoch.load();
+        if (epoch != 0 && epoch < min_active) {
+            min_active = epoch;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++) {
+        if (retired[i].epoch < min_active) {
+            retired[i].deleter(retired[i].object);
+        } else {
+            retired[kept++] = retired[i];
+        }
+    }
+    retired.resize(kept);
+}
+
+size_t EpochReclaimer::pending() const {
+    lock_guard<mutex> lock(retired_mutex);
+    return retired.size();
+}
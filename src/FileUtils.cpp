@@ -32,6 +32,30 @@ bool FileUtils::write_text_file(const string& filepath, const string& content) {
     return true;
 }
 
+bool FileUtils::write_text_file_atomic(const string& filepath, const string& content) {
+    string tmp_path = filepath + ".tmp";
+    {
+        ofstream file(tmp_path, ios::binary | ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << content;
+        file.flush();
+        if (!file.good()) {
+            return false;
+        }
+    }
+    
+    error_code ec;
+    fs::rename(tmp_path, filepath, ec);
+    if (ec) {
+        cerr << "Error: Cannot replace " << filepath << ": " << ec.message() << endl;
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
 string FileUtils::get_file_extension(const string& filename) {
     size_t dot_pos = filename.find_last_of('.');
     if (dot_pos == string::npos) {
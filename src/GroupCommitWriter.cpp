@@ -0,0 +1,151 @@
+#include "GroupCommitWriter.h"
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+GroupCommitWriter& GroupCommitWriter::instance() {
+    static GroupCommitWriter writer(getenv("GROUP_COMMIT_WINDOW_US") ?
+                                    atoi(getenv("GROUP_COMMIT_WINDOW_US")) : 1000);
+    return writer;
+}
+
+GroupCommitWriter::GroupCommitWriter(int window_us) : window_us(window_us < 0 ? 0 : window_us) {}
+
+bool GroupCommitWriter::write(const string& path, const string& content) {
+    unique_lock<mutex> lock(batch_mutex);
+    shared_ptr<Batch> batch = open_batch;
+    bool leader = !batch;
+    if (leader) {
+        batch = make_shared<Batch>();
+        open_batch = batch;
+    }
+    batch->files[path] = content;
+
+    if (!leader) {
+        batch_done.wait(lock, [&batch] { return batch->done; });
+        return batch->results[path];
+    }
+
+    // 第一个写入者负责提交：先等待窗口期，再等上一批提交完成，期间到达的写入都加入本批
+    lock.unlock();
+    if (window_us > 0) {
+        this_thread::sleep_for(chrono::microseconds(window_us));
+    }
+    lock_guard<mutex> commit_lock(commit_mutex);
+
+    lock.lock();
+    open_batch.reset();
+    lock.unlock();
+
+    // 批次已关闭，不会再被其他线程修改
+    commit(*batch);
+
+    lock.lock();
+    batch->done = true;
+    batch_count++;
+    file_count += batch->files.size();
+    bool success = batch->results[path];
+    lock.unlock();
+    batch_done.notify_all();
+    return success;
+}
+
+uint64_t GroupCommitWriter::get_batch_count() const {
+    lock_guard<mutex> lock(batch_mutex);
+    return batch_count;
+}
+
+uint64_t GroupCommitWriter::get_file_count() const {
+    lock_guard<mutex> lock(batch_mutex);
+    return file_count;
+}
+
+void GroupCommitWriter::commit(Batch& batch) {
+    // 1. 全部写入临时文件并 fsync
+    for (const auto& [path, content] : batch.files) {
+        batch.results[path] = write_synced(path + ".tmp", content);
+    }
+
+    // 2. 重命名覆盖目标文件
+    map<string, vector<string>> directories;
+    for (const auto& [path, content] : batch.files) {
+        if (!batch.results[path]) {
+            continue;
+        }
+        error_code ec;
+        fs::rename(path + ".tmp", path, ec);
+        if (ec) {
+            cerr << "Error: Cannot replace " << path << ": " << ec.message() << endl;
+            fs::remove(path + ".tmp", ec);
+            batch.results[path] = false;
+            continue;
+        }
+        string directory = fs::path(path).parent_path().string();
+        directories[directory.empty() ? "." : directory].push_back(path);
+    }
+
+    // 3. 每个目录只 fsync 一次，覆盖本批所有重命名
+    for (const auto& [directory, paths] : directories) {
+        if (!sync_directory(directory)) {
+            for (const string& path : paths) {
+                batch.results[path] = false;
+            }
+        }
+    }
+}
+
+bool GroupCommitWriter::write_synced(const string& path, const string& content) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        cerr << "Error: Cannot open " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+
+    const char* data = content.data();
+    size_t remaining = content.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Error: Cannot write " << path << ": " << strerror(errno) << endl;
+            close(fd);
+            unlink(path.c_str());
+            return false;
+        }
+        data += written;
+        remaining -= written;
+    }
+
+    if (fsync(fd) != 0) {
+        cerr << "Error: Cannot sync " << path << ": " << strerror(errno) << endl;
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    return close(fd) == 0;
+}
+
+bool GroupCommitWriter::sync_directory(const string& directory) {
+    int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        cerr << "Error: Cannot open directory " << directory << ": " << strerror(errno) << endl;
+        return false;
+    }
+    bool success = fsync(fd) == 0;
+    if (!success) {
+        cerr << "Error: Cannot sync directory " << directory << ": " << strerror(errno) << endl;
+    }
+    close(fd);
+    return success;
+}
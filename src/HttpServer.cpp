@@ -3,10 +3,25 @@
 #include <iostream>
 #include <fstream>
 
-HttpServer::HttpServer(std::shared_ptr<WordApp> word_app) : app(word_app) {
+HttpServer::HttpServer(std::shared_ptr<WordApp> word_app, const ServerConfig& config)
+    : app(word_app), config(config),
+      audio_pack(config.audio_pack),
+      speech_jobs(config.tts_workers, config.tts_queue, &audio_pack, config.reader_socket),
+      word_audio(audio_pack) {
+    // 用工作窃取队列替换 httplib 默认的线程池
+    server.new_task_queue = [this] {
+        WorkStealingTaskQueue* queue = new WorkStealingTaskQueue(
+            this->config.threads, this->config.max_queue, this->config.spare_threads);
+        task_queue = queue;
+        return queue;
+    };
+    
     setup_cors();
     setup_static_routes();
     setup_api_routes();
+    if (this->config.debug_routes) {
+        setup_debug_routes();
+    }
 }
 
 void HttpServer::setup_cors() {
@@ -14,7 +29,7 @@ void HttpServer::setup_cors() {
     server.set_pre_routing_handler([](const httplib::Request&, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin", "*");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, X-Session-Token");
         return httplib::Server::HandlerResponse::Unhandled;
     });
     
@@ -78,26 +93,34 @@ void HttpServer::setup_static_routes() {
 void HttpServer::setup_api_routes() {
     // API端点
     server.Get("/get_learn_words", [this](const httplib::Request& req, httplib::Response& res) {
+        shared_ptr<UserContext> context = require_user(req, res);
+        if (!context) return;
+        
         int page = 1;
         if (req.has_param("page")) {
             page = stoi(req.get_param_value("page"));
         }
         
-        json result = app->get_learn_words(page);
+        json result = app->get_learn_words(*context, page);
         res.set_content(result.dump(), "application/json");
     });
     
-    server.Get("/get_exam_words", [this](const httplib::Request&, httplib::Response& res) {
+    server.Get("/get_exam_words", [this](const httplib::Request& req, httplib::Response& res) {
+        if (!require_user(req, res)) return;
+        
         json result = app->get_exam_words();
         res.set_content(result.dump(), "application/json");
     });
     
     server.Post("/update_mistakes_batch", [this](const httplib::Request& req, httplib::Response& res) {
+        shared_ptr<UserContext> context = require_user(req, res);
+        if (!context) return;
+        
         try {
             json request_data = json::parse(req.body);
             vector<string> words = request_data["words"];
             
-            bool success = app->update_mistakes_batch(words);
+            bool success = app->update_mistakes_batch(*context, words);
             res.set_content(json{{"success", success}}.dump(), "application/json");
         } catch (const exception& e) {
             res.status = 400;
@@ -106,22 +129,31 @@ void HttpServer::setup_api_routes() {
     });
     
     server.Get("/get_review_words", [this](const httplib::Request& req, httplib::Response& res) {
+        shared_ptr<UserContext> context = require_user(req, res);
+        if (!context) return;
+        
         int page = 1;
         if (req.has_param("page")) {
             page = stoi(req.get_param_value("page"));
         }
         
-        json result = app->get_review_words(page);
+        json result = app->get_review_words(*context, page);
         res.set_content(result.dump(), "application/json");
     });
     
-    server.Get("/get_all_review_words", [this](const httplib::Request&, httplib::Response& res) {
-        json result = app->get_all_review_words();
+    server.Get("/get_all_review_words", [this](const httplib::Request& req, httplib::Response& res) {
+        shared_ptr<UserContext> context = require_user(req, res);
+        if (!context) return;
+        
+        json result = app->get_all_review_words(*context);
         res.set_content(result.dump(), "application/json");
     });
     
-    server.Get("/get_stats", [this](const httplib::Request&, httplib::Response& res) {
-        json result = app->get_stats();
+    server.Get("/get_stats", [this](const httplib::Request& req, httplib::Response& res) {
+        shared_ptr<UserContext> context = require_user(req, res);
+        if (!context) return;
+        
+        json result = app->get_stats(*context);
         res.set_content(result.dump(), "application/json");
     });
     
@@ -131,6 +163,8 @@ void HttpServer::setup_api_routes() {
             word = req.get_param_value("word");
         }
         
+        // 外部词典查询较慢，期间由备用线程处理其他请求
+        WorkStealingTaskQueue::BlockingScope slow;
         json result = app->dictionary_search(word);
         res.set_content(result.dump(), "application/json");
     });
@@ -144,6 +178,9 @@ void HttpServer::setup_api_routes() {
             string username = request_data["username"];
             
             json result = app->login_user(username);
+            if (result["success"].get<bool>()) {
+                set_session_cookie(res, result["session_token"]);
+            }
             res.set_content(result.dump(), "application/json");
         } catch (const exception& e) {
             res.status = 400;
@@ -166,8 +203,8 @@ void HttpServer::setup_api_routes() {
     });
     
     // 获取当前用户信息
-    server.Get("/current_user", [this](const httplib::Request&, httplib::Response& res) {
-        json result = app->get_current_user();
+    server.Get("/current_user", [this](const httplib::Request& req, httplib::Response& res) {
+        json result = app->get_current_user(get_session_token(req));
         res.set_content(result.dump(), "application/json");
     });
     
@@ -177,7 +214,10 @@ void HttpServer::setup_api_routes() {
             json request_data = json::parse(req.body);
             string username = request_data["username"];
             
-            json result = app->switch_user(username);
+            json result = app->switch_user(get_session_token(req), username);
+            if (result["success"].get<bool>()) {
+                set_session_cookie(res, result["session_token"]);
+            }
             res.set_content(result.dump(), "application/json");
         } catch (const exception& e) {
             res.status = 400;
@@ -186,14 +226,15 @@ void HttpServer::setup_api_routes() {
     });
     
     // 用户登出
-    server.Post("/logout", [this](const httplib::Request&, httplib::Response& res) {
-        json result = app->logout_user();
+    server.Post("/logout", [this](const httplib::Request& req, httplib::Response& res) {
+        json result = app->logout_user(get_session_token(req));
+        set_session_cookie(res, "");
         res.set_content(result.dump(), "application/json");
     });
     
     // 获取用户列表
-    server.Get("/users", [this](const httplib::Request&, httplib::Response& res) {
-        json result = app->get_user_list();
+    server.Get("/users", [this](const httplib::Request& req, httplib::Response& res) {
+        json result = app->get_user_list(get_session_token(req));
         res.set_content(result.dump(), "application/json");
     });
     
@@ -208,12 +249,15 @@ void HttpServer::setup_api_routes() {
     
     // 重置用户进度
     server.Post("/reset_progress", [this](const httplib::Request& req, httplib::Response& res) {
+        shared_ptr<UserContext> context = require_user(req, res);
+        if (!context) return;
+        
         try {
             json request_data = json::parse(req.body);
             bool reset_mistakes = request_data.value("reset_mistakes", false);
             bool reset_position = request_data.value("reset_position", true);
             
-            json result = app->reset_user_progress(reset_mistakes, reset_position);
+            json result = app->reset_user_progress(*context, reset_mistakes, reset_position);
             res.set_content(result.dump(), "application/json");
         } catch (const exception& e) {
             res.status = 400;
@@ -223,7 +267,7 @@ void HttpServer::setup_api_routes() {
     
     // ===== 单词朗读器 API =====
     
-    // 单个单词朗读API
+    // 单个单词朗读API：只排队，立即返回任务编号
     server.Post("/speak", [this](const httplib::Request& req, httplib::Response& res) {
         try {
             json request_data = json::parse(req.body);
@@ -234,22 +278,278 @@ void HttpServer::setup_api_routes() {
                 res.set_content(json{{"status", "error"}, {"message", "No word provided"}}.dump(), "application/json");
                 return;
             }
+            if (word.size() > 200) {
+                res.status = 400;
+                res.set_content(json{{"status", "error"}, {"message", "Text too long"}}.dump(), "application/json");
+                return;
+            }
             
-            // 调用C++朗读程序
-            string command = "cd listen && ./word_reader \"" + word + "\"";
-            int result = system(command.c_str());
-            
-            if (result == 0) {
-                res.set_content(json{{"status", "success"}, {"message", "Spoke word: " + word}}.dump(), "application/json");
-            } else {
-                res.set_content(json{{"status", "error"}, {"message", "Failed to speak word: " + word}}.dump(), "application/json");
+            uint64_t job_id = speech_jobs.submit(word);
+            if (job_id == 0) {
+                res.status = 503;
+                res.set_header("Retry-After", "1");
+                res.set_content(json{{"status", "error"}, {"message", "Speech queue is full"}}.dump(), "application/json");
+                return;
             }
             
+            res.status = 202;
+            res.set_content(json{
+                {"status", "accepted"},
+                {"message", "Queued word: " + word},
+                {"job_id", job_id},
+                {"status_url", "/speak/" + to_string(job_id)}
+            }.dump(), "application/json");
+            
         } catch (const exception& e) {
             res.status = 500;
             res.set_content(json{{"status", "error"}, {"message", string("Internal server error: ") + e.what()}}.dump(), "application/json");
         }
     });
+    
+    // 朗读任务状态
+    server.Get(R"(/speak/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+        json job;
+        if (!speech_jobs.get_status(stoull(req.matches[1].str()), job)) {
+            res.status = 404;
+            res.set_content(json{{"status", "error"}, {"message", "Unknown speech job"}}.dump(), "application/json");
+            return;
+        }
+        res.set_content(json{{"status", "success"}, {"job", job}}.dump(), "application/json");
+    });
+    
+    // 单词发音（WAV），在浏览器中播放，不占用服务器的声卡
+    server.Get(R"(/audio/([^/]+))", [this](const httplib::Request& req, httplib::Response& res) {
+        vector<string> words = {req.matches[1].str()};
+        if (!check_audio_words(words, res)) {
+            return;
+        }
+        
+        WordAudio::Body body;
+        bool found = word_audio.find(words[0], body);
+        if (!found) {
+            WorkStealingTaskQueue::BlockingScope slow;
+            found = word_audio.get(words[0], body);
+        }
+        if (!found) {
+            res.status = 503;
+            res.set_content(json{{"status", "error"}, {"message", "Speech synthesis failed"}}.dump(), "application/json");
+            return;
+        }
+        send_audio(req, res, move(body));
+    });
+    
+    // 单词序列（/audio?words=apple+banana&pause=800），各单词之间插入静音，拼成一个 WAV
+    server.Get("/audio", [this](const httplib::Request& req, httplib::Response& res) {
+        vector<string> words = WordAudio::split_words(req.get_param_value("words"));
+        if (!check_audio_words(words, res)) {
+            return;
+        }
+        int pause_ms = 800;
+        try {
+            if (req.has_param("pause")) {
+                pause_ms = stoi(req.get_param_value("pause"));
+            }
+        } catch (const exception&) {
+            pause_ms = -1;
+        }
+        if (pause_ms < 0 || pause_ms > WordAudio::MAX_PAUSE_MS) {
+            res.status = 400;
+            res.set_content(json{{"status", "error"}, {"message", "Invalid pause"}}.dump(), "application/json");
+            return;
+        }
+        
+        send_sequence(req, res, move(words), pause_ms);
+    });
+    
+    // 批量朗读：{"words": [...]} 或 {"text": "apple banana"}，可选 "pause"（毫秒，默认 800）
+    // 返回一个拼接好的 WAV 流，由浏览器播放
+    server.Post("/speak_words", [this](const httplib::Request& req, httplib::Response& res) {
+        vector<string> words;
+        int pause_ms;
+        try {
+            json request_data = json::parse(req.body);
+            if (request_data.contains("words")) {
+                words = request_data["words"].get<vector<string>>();
+            } else {
+                words = WordAudio::split_words(request_data.value("text", ""));
+            }
+            pause_ms = request_data.value("pause", 800);
+        } catch (const exception& e) {
+            res.status = 400;
+            res.set_content(json{{"status", "error"}, {"message", string("Invalid request: ") + e.what()}}.dump(), "application/json");
+            return;
+        }
+        if (!check_audio_words(words, res)) {
+            return;
+        }
+        if (pause_ms < 0 || pause_ms > WordAudio::MAX_PAUSE_MS) {
+            res.status = 400;
+            res.set_content(json{{"status", "error"}, {"message", "Invalid pause"}}.dump(), "application/json");
+            return;
+        }
+        send_sequence(req, res, move(words), pause_ms);
+    });
+}
+
+bool HttpServer::check_audio_words(const vector<string>& words, httplib::Response& res) {
+    string message;
+    if (words.empty()) {
+        message = "No word provided";
+    } else if (words.size() > WordAudio::MAX_WORDS) {
+        message = "Too many words";
+    }
+    for (const string& word : words) {
+        if (word.size() > WordAudio::MAX_WORD_LENGTH) {
+            message = "Word too long";
+        }
+    }
+    if (message.empty()) {
+        return true;
+    }
+    res.status = 400;
+    res.set_content(json{{"status", "error"}, {"message", message}}.dump(), "application/json");
+    return false;
+}
+
+void HttpServer::send_audio(const httplib::Request& req, httplib::Response& res, WordAudio::Body body) {
+    string etag = body.etag();
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", "public, max-age=31536000, immutable");
+    res.set_header("Accept-Ranges", "bytes");
+    
+    string if_none_match = req.get_header_value("If-None-Match");
+    if (!if_none_match.empty() && (if_none_match == "*" || if_none_match.find(etag) != string::npos)) {
+        res.status = 304;
+        return;
+    }
+    
+    size_t size = body.size;
+    auto shared_body = make_shared<const WordAudio::Body>(move(body));
+    res.set_content_provider(size, "audio/wav",
+        [shared_body](size_t offset, size_t length, httplib::DataSink& sink) {
+            return shared_body->write(offset, length, [&sink](const char* data, size_t count) {
+                return sink.write(data, count);
+            });
+        });
+}
+
+void HttpServer::send_sequence(const httplib::Request& req, httplib::Response& res, vector<string> words, int pause_ms) {
+    // 全部单词都已有音频时长度已知，可以缓存与按范围读取；否则边合成边输出
+    WordAudio::Body body;
+    if (word_audio.find_sequence(words, pause_ms, body)) {
+        send_audio(req, res, move(body));
+    } else {
+        stream_audio(res, move(words), pause_ms);
+    }
+}
+
+void HttpServer::stream_audio(httplib::Response& res, vector<string> words, int pause_ms) {
+    if (!SpeechEngine::instance().available()) {
+        res.status = 503;
+        res.set_content(json{{"status", "error"}, {"message", "No TTS engine available"}}.dump(), "application/json");
+        return;
+    }
+    
+    // 后台线程提前合成后面的单词，发送第 N 个单词时第 N+1 个已在合成
+    auto pipeline = make_shared<WordAudio::Pipeline>(word_audio, move(words), pause_ms);
+    res.set_header("Cache-Control", "no-cache");
+    res.set_chunked_content_provider("audio/wav", [pipeline](size_t, httplib::DataSink& sink) {
+        WordAudio::Body body;
+        bool more;
+        {
+            WorkStealingTaskQueue::BlockingScope slow;
+            more = pipeline->next(body);
+        }
+        if (!more) {
+            sink.done();
+            return true;
+        }
+        return body.write(0, body.size, [&sink](const char* data, size_t count) {
+            return sink.write(data, count);
+        });
+    });
+}
+
+string HttpServer::get_session_token(const httplib::Request& req) {
+    string token = req.get_header_value("X-Session-Token");
+    if (!token.empty()) {
+        return token;
+    }
+    
+    // Cookie: a=1; session_token=xxx; b=2
+    string cookies = req.get_header_value("Cookie");
+    const string name = "session_token=";
+    size_t pos = 0;
+    while (pos < cookies.size()) {
+        size_t end = cookies.find(';', pos);
+        if (end == string::npos) {
+            end = cookies.size();
+        }
+        size_t start = cookies.find_first_not_of(' ', pos);
+        if (start < end && cookies.compare(start, name.size(), name) == 0) {
+            return cookies.substr(start + name.size(), end - start - name.size());
+        }
+        pos = end + 1;
+    }
+    return "";
+}
+
+void HttpServer::set_session_cookie(httplib::Response& res, const string& token) {
+    if (token.empty()) {
+        res.set_header("Set-Cookie", "session_token=; Path=/; Max-Age=0; HttpOnly; SameSite=Lax");
+    } else {
+        res.set_header("Set-Cookie", "session_token=" + token + "; Path=/; HttpOnly; SameSite=Lax");
+    }
+}
+
+shared_ptr<UserContext> HttpServer::require_user(const httplib::Request& req, httplib::Response& res) {
+    shared_ptr<UserContext> context = app->get_user_context(get_session_token(req));
+    if (!context) {
+        res.set_content(json{{"success", false}, {"error", "No user logged in"}}.dump(), "application/json");
+    }
+    return context;
+}
+
+void HttpServer::setup_debug_routes() {
+    // 调试：全量重新统计，报告增量计数的偏差
+    server.Get("/debug/recount_stats", [this](const httplib::Request& req, httplib::Response& res) {
+        shared_ptr<UserContext> context = require_user(req, res);
+        if (!context) return;
+        
+        json result = app->recount_stats(*context);
+        res.set_content(result.dump(), "application/json");
+    });
+    
+    // 调试：用户上下文缓存的命中、未命中与淘汰统计
+    server.Get("/debug/cache_stats", [this](const httplib::Request&, httplib::Response& res) {
+        json result = app->get_cache_stats();
+        res.set_content(result.dump(), "application/json");
+    });
+    
+    // 调试：请求线程池的排队长度、排队时间与窃取统计
+    server.Get("/debug/server_stats", [this](const httplib::Request&, httplib::Response& res) {
+        json result = {{"success", true}, {"host", config.host}, {"port", config.port}};
+        WorkStealingTaskQueue* queue = task_queue.load();
+        if (queue) {
+            result["task_queue"] = queue->get_stats();
+        }
+        result["speech_jobs"] = speech_jobs.get_stats();
+        result["word_audio"] = word_audio.get_stats();
+        result["dictionary"] = app->get_dictionary_stats();
+        result["audio_pack"] = {
+            {"path", config.audio_pack},
+            {"loaded", audio_pack.is_open()},
+            {"words", audio_pack.size()},
+            {"sample_rate", audio_pack.sample_rate()}
+        };
+        res.set_content(result.dump(), "application/json");
+    });
+    
+    // 调试：用户锁各分片的加锁与争用统计
+    server.Get("/debug/lock_stats", [this](const httplib::Request&, httplib::Response& res) {
+        json result = app->get_lock_stats();
+        res.set_content(result.dump(), "application/json");
+    });
 }
 
 string HttpServer::get_content_type(const string& filename) {
@@ -265,13 +565,26 @@ string HttpServer::get_content_type(const string& filename) {
     else return "text/plain";
 }
 
-bool HttpServer::start(const string& host, int port) {
-    cout << "Starting C++ Word Learning Server on " << host << ":" << port << "..." << endl;
-    cout << "Open your browser and visit: http://localhost:" << port << endl;
+bool HttpServer::start() {
+    cout << "Starting C++ Word Learning Server on " << config.host << ":" << config.port << "..." << endl;
+    cout << "Request workers: " << config.threads << " (+" << config.spare_threads << " spare), max queue: "
+         << config.max_queue << endl;
+    if (audio_pack.is_open()) {
+        cout << "Audio pack: " << audio_pack.size() << " words from " << config.audio_pack << endl;
+    } else {
+        cout << "Audio pack: not loaded (" << config.audio_pack << "), speaking with live synthesis" << endl;
+    }
+    if (config.debug_routes) {
+        cout << "Debug routes: enabled under /debug/ (no login required)" << endl;
+    }
+    cout << "Open your browser and visit: http://localhost:" << config.port << endl;
     cout << "Press Ctrl+C to stop the server." << endl;
     
-    if (!server.listen(host.c_str(), port)) {
-        cerr << "Error: Failed to start server on port " << port << endl;
+    bool listened = server.listen(config.host.c_str(), config.port);
+    // listen 返回后 httplib 已释放任务队列
+    task_queue = nullptr;
+    if (!listened) {
+        cerr << "Error: Failed to start server on port " << config.port << endl;
         cerr << "The port might be already in use." << endl;
         return false;
     }
@@ -0,0 +1,159 @@
+#include "ProgressCompactor.h"
+#include <iostream>
+#include <filesystem>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+ProgressCompactor::ProgressCompactor(const string& users_dir, const UserProgressFile& progress_file,
+                                     uintmax_t max_log_bytes, int max_log_age, int scan_interval)
+    : USERS_DIR(users_dir), progress_log(users_dir, progress_file.get_catalog()), progress_file(progress_file),
+      max_log_bytes(max_log_bytes), max_log_age(max_log_age), scan_interval(scan_interval),
+      stopping(false) {}
+
+ProgressCompactor::~ProgressCompactor() {
+    stop();
+}
+
+void ProgressCompactor::start() {
+    lock_guard<mutex> lock(state_mutex);
+    if (worker.joinable()) {
+        return;
+    }
+    stopping = false;
+    worker = thread(&ProgressCompactor::run, this);
+}
+
+void ProgressCompactor::stop() {
+    {
+        lock_guard<mutex> lock(state_mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void ProgressCompactor::request(const string& username) {
+    {
+        lock_guard<mutex> lock(state_mutex);
+        requested.insert(username);
+    }
+    wakeup.notify_all();
+}
+
+void ProgressCompactor::cancel(const string& username) {
+    lock_guard<mutex> lock(state_mutex);
+    requested.erase(username);
+    dirty_since.erase(username);
+}
+
+uintmax_t ProgressCompactor::get_max_log_bytes() const {
+    return max_log_bytes;
+}
+
+void ProgressCompactor::run() {
+    unique_lock<mutex> lock(state_mutex);
+    while (!stopping) {
+        wakeup.wait_for(lock, chrono::seconds(scan_interval),
+                        [this] { return stopping || !requested.empty(); });
+        if (stopping) {
+            break;
+        }
+
+        set<string> users;
+        users.swap(requested);
+        lock.unlock();
+
+        for (const string& username : users) {
+            compact(username);
+        }
+        scan();
+
+        lock.lock();
+    }
+}
+
+void ProgressCompactor::scan() {
+    time_t now = time(nullptr);
+    set<string> due;
+
+    try {
+        for (const auto& entry : fs::directory_iterator(USERS_DIR)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+
+            string username;
+            bool interrupted = false;
+            if (entry.path().extension() == ".log") {
+                username = entry.path().stem().string();
+            } else if (entry.path().extension() == ".compacting") {
+                // 上次压缩中断留下的日志，直接重新压缩
+                username = entry.path().stem().stem().string();
+                interrupted = true;
+            } else {
+                continue;
+            }
+
+            error_code ec;
+            uintmax_t bytes = entry.file_size(ec);
+            if (ec || (bytes == 0 && !interrupted)) {
+                continue;
+            }
+
+            lock_guard<mutex> lock(state_mutex);
+            auto it = dirty_since.emplace(username, now).first;
+            if (interrupted || bytes >= max_log_bytes || now - it->second >= max_log_age) {
+                due.insert(username);
+            }
+        }
+    } catch (const fs::filesystem_error& e) {
+        cerr << "Error scanning progress logs: " << e.what() << endl;
+        return;
+    }
+
+    for (const string& username : due) {
+        compact(username);
+    }
+}
+
+bool ProgressCompactor::compact(const string& username) {
+    {
+        lock_guard<mutex> lock(state_mutex);
+        dirty_since.erase(username);
+    }
+
+    lock_guard<mutex> snapshot_lock(UserProgressLog::snapshot_mutex(username));
+    if (!progress_file.exists(username)) {
+        // 用户已被删除，只剩删除前未写完的日志，合并会把用户重新写回
+        progress_log.remove(username);
+        return true;
+    }
+    if (!progress_log.rotate(username)) {
+        return true;
+    }
+
+    UserProgress progress;
+    if (!progress_file.load(username, progress)) {
+        cerr << "Error: Cannot load user data for compaction: " << username << endl;
+        return false;
+    }
+
+    // 只合并轮转出来的日志：当前日志仍在被追加，末行可能不完整
+    progress.log_seq = UserProgressLog::replay_file(
+        progress_log.get_compacting_file(username), progress_file.get_catalog(),
+        progress.log_seq, progress.log_seq,
+        [&progress](const UserProgressLog::Record& record) {
+            progress.apply(record);
+        });
+
+    if (!progress_file.save(username, progress)) {
+        cerr << "Error: Cannot write compacted snapshot for " << username << endl;
+        return false;
+    }
+
+    progress_log.remove_compacting(username);
+    return true;
+}
@@ -0,0 +1,194 @@
+#include "ProgressKernels.h"
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PROGRESS_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// 每块的元素数：16位零计数器与32位和累加器在一块之内都不会溢出，
+// 每块结束后再合并到64位总数
+constexpr size_t BLOCK_SIZE = 1 << 15;
+
+#ifdef PROGRESS_KERNELS_X86
+
+uint64_t horizontal_sum_u16(__m128i vector) {
+    alignas(16) uint16_t lanes[8];
+    _mm_store_si128((__m128i*)lanes, vector);
+    uint64_t sum = 0;
+    for (uint16_t lane : lanes) sum += lane;
+    return sum;
+}
+
+uint64_t horizontal_sum_u32(__m128i vector) {
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128((__m128i*)lanes, vector);
+    uint64_t sum = 0;
+    for (uint32_t lane : lanes) sum += lane;
+    return sum;
+}
+
+__attribute__((target("avx2")))
+uint64_t horizontal_sum_u16(__m256i vector) {
+    return horizontal_sum_u16(_mm256_castsi256_si128(vector)) +
+           horizontal_sum_u16(_mm256_extracti128_si256(vector, 1));
+}
+
+__attribute__((target("avx2")))
+uint64_t horizontal_sum_u32(__m256i vector) {
+    return horizontal_sum_u32(_mm256_castsi256_si128(vector)) +
+           horizontal_sum_u32(_mm256_extracti128_si256(vector, 1));
+}
+
+#endif
+
+void aggregate_tail(const uint16_t* mistakes, const uint16_t* correct, size_t begin, size_t end,
+                    ProgressTotals& totals) {
+    for (size_t i = begin; i < end; i++) {
+        totals.review_count += mistakes[i] > 0;
+        totals.total_mistakes += mistakes[i];
+        totals.total_correct += correct[i];
+    }
+}
+
+}
+
+ProgressTotals ProgressKernels::aggregate_scalar(const uint16_t* mistakes, const uint16_t* correct,
+                                                 size_t count) {
+    ProgressTotals totals;
+    aggregate_tail(mistakes, correct, 0, count, totals);
+    return totals;
+}
+
+#ifdef PROGRESS_KERNELS_X86
+
+__attribute__((target("sse2")))
+ProgressTotals ProgressKernels::aggregate_sse2(const uint16_t* mistakes, const uint16_t* correct,
+                                               size_t count) {
+    constexpr size_t LANES = 8;
+    ProgressTotals totals;
+    const __m128i zero = _mm_setzero_si128();
+    size_t vector_end = count - count % LANES;
+    uint64_t zero_words = 0;
+
+    for (size_t block = 0; block < vector_end; block += BLOCK_SIZE) {
+        size_t block_end = block + BLOCK_SIZE < vector_end ? block + BLOCK_SIZE : vector_end;
+        __m128i zero_count = zero;
+        __m128i mistake_sum = zero;
+        __m128i correct_sum = zero;
+
+        for (size_t i = block; i < block_end; i += LANES) {
+            __m128i m = _mm_loadu_si128((const __m128i*)(mistakes + i));
+            __m128i c = _mm_loadu_si128((const __m128i*)(correct + i));
+            // 比较结果为全1（即 -1），相减等于为零的通道加1
+            zero_count = _mm_sub_epi16(zero_count, _mm_cmpeq_epi16(m, zero));
+            mistake_sum = _mm_add_epi32(mistake_sum, _mm_unpacklo_epi16(m, zero));
+            mistake_sum = _mm_add_epi32(mistake_sum, _mm_unpackhi_epi16(m, zero));
+            correct_sum = _mm_add_epi32(correct_sum, _mm_unpacklo_epi16(c, zero));
+            correct_sum = _mm_add_epi32(correct_sum, _mm_unpackhi_epi16(c, zero));
+        }
+
+        zero_words += horizontal_sum_u16(zero_count);
+        totals.total_mistakes += horizontal_sum_u32(mistake_sum);
+        totals.total_correct += horizontal_sum_u32(correct_sum);
+    }
+
+    totals.review_count = vector_end - zero_words;
+    aggregate_tail(mistakes, correct, vector_end, count, totals);
+    return totals;
+}
+
+__attribute__((target("avx2")))
+ProgressTotals ProgressKernels::aggregate_avx2(const uint16_t* mistakes, const uint16_t* correct,
+                                               size_t count) {
+    constexpr size_t LANES = 16;
+    ProgressTotals totals;
+    const __m256i zero = _mm256_setzero_si256();
+    size_t vector_end = count - count % LANES;
+    uint64_t zero_words = 0;
+
+    for (size_t block = 0; block < vector_end; block += BLOCK_SIZE) {
+        size_t block_end = block + BLOCK_SIZE < vector_end ? block + BLOCK_SIZE : vector_end;
+        __m256i zero_count = zero;
+        __m256i mistake_sum = zero;
+        __m256i correct_sum = zero;
+
+        for (size_t i = block; i < block_end; i += LANES) {
+            __m256i m = _mm256_loadu_si256((const __m256i*)(mistakes + i));
+            __m256i c = _mm256_loadu_si256((const __m256i*)(correct + i));
+            zero_count = _mm256_sub_epi16(zero_count, _mm256_cmpeq_epi16(m, zero));
+            // unpack 在每个128位通道内交错，只求和所以顺序无关
+            mistake_sum = _mm256_add_epi32(mistake_sum, _mm256_unpacklo_epi16(m, zero));
+            mistake_sum = _mm256_add_epi32(mistake_sum, _mm256_unpackhi_epi16(m, zero));
+            correct_sum = _mm256_add_epi32(correct_sum, _mm256_unpacklo_epi16(c, zero));
+            correct_sum = _mm256_add_epi32(correct_sum, _mm256_unpackhi_epi16(c, zero));
+        }
+
+        zero_words += horizontal_sum_u16(zero_count);
+        totals.total_mistakes += horizontal_sum_u32(mistake_sum);
+        totals.total_correct += horizontal_sum_u32(correct_sum);
+    }
+
+    totals.review_count = vector_end - zero_words;
+    aggregate_tail(mistakes, correct, vector_end, count, totals);
+    return totals;
+}
+
+bool ProgressKernels::has_sse2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+}
+
+bool ProgressKernels::has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+ProgressTotals ProgressKernels::aggregate_sse2(const uint16_t* mistakes, const uint16_t* correct,
+                                               size_t count) {
+    return aggregate_scalar(mistakes, correct, count);
+}
+
+ProgressTotals ProgressKernels::aggregate_avx2(const uint16_t* mistakes, const uint16_t* correct,
+                                               size_t count) {
+    return aggregate_scalar(mistakes, correct, count);
+}
+
+bool ProgressKernels::has_sse2() {
+    return false;
+}
+
+bool ProgressKernels::has_avx2() {
+    return false;
+}
+
+#endif
+
+ProgressKernels::AggregateFunction ProgressKernels::select() {
+    if (getenv("PROGRESS_KERNELS_SCALAR")) {
+        return aggregate_scalar;
+    }
+    if (has_avx2()) {
+        return aggregate_avx2;
+    }
+    if (has_sse2()) {
+        return aggregate_sse2;
+    }
+    return aggregate_scalar;
+}
+
+ProgressTotals ProgressKernels::aggregate(const uint16_t* mistakes, const uint16_t* correct, size_t count) {
+    static const AggregateFunction function = select();
+    return function(mistakes, correct, count);
+}
+
+const char* ProgressKernels::implementation() {
+    AggregateFunction function = select();
+    if (function == aggregate_avx2) return "avx2";
+    if (function == aggregate_sse2) return "sse2";
+    return "scalar";
+}
@@ -0,0 +1,176 @@
+#include "ReviewIndex.h"
+#include <algorithm>
+
+ReviewIndex::ReviewIndex(const vector<uint32_t>* word_ranks)
+    : word_ranks(word_ranks), head(make_unique<Node>()), generator(0x5eed) {
+    head->levels.resize(MAX_LEVEL);
+}
+
+bool ReviewIndex::less(const Key& a, const Key& b) {
+    if (a.mistakes != b.mistakes) {
+        return a.mistakes > b.mistakes;
+    }
+    if (a.last_seen != b.last_seen) {
+        return a.last_seen < b.last_seen;
+    }
+    if (a.rank != b.rank) {
+        return a.rank < b.rank;
+    }
+    return a.id < b.id;
+}
+
+int ReviewIndex::random_level() {
+    // 每层以 1/4 的概率晋升
+    int node_level = 1;
+    while (node_level < MAX_LEVEL && (generator() & 3) == 0) {
+        node_level++;
+    }
+    return node_level;
+}
+
+void ReviewIndex::update(uint32_t id, uint16_t mistakes, uint32_t last_seen) {
+    unique_ptr<Node> node = erase(id);
+    if (mistakes == 0) {
+        if (node) {
+            level_count -= node->levels.size();
+        }
+        return;
+    }
+
+    if (!node) {
+        node = make_unique<Node>();
+        node->levels.resize(random_level());
+        level_count += node->levels.size();
+    }
+    node->key.mistakes = mistakes;
+    node->key.last_seen = last_seen;
+    node->key.rank = word_ranks && id < word_ranks->size() ? (*word_ranks)[id] : id;
+    node->key.id = id;
+    insert(std::move(node));
+}
+
+void ReviewIndex::insert(unique_ptr<Node> node) {
+    Node* update[MAX_LEVEL];
+    size_t rank[MAX_LEVEL];
+
+    // 自顶向下找到每层的前驱，并记录前驱的名次
+    Node* x = head.get();
+    for (int i = level - 1; i >= 0; i--) {
+        rank[i] = i == level - 1 ? 0 : rank[i + 1];
+        while (x->levels[i].next && less(x->levels[i].next->key, node->key)) {
+            rank[i] += x->levels[i].span;
+            x = x->levels[i].next;
+        }
+        update[i] = x;
+    }
+
+    int node_level = node->levels.size();
+    if (node_level > level) {
+        for (int i = level; i < node_level; i++) {
+            rank[i] = 0;
+            update[i] = head.get();
+            head->levels[i].span = length;
+        }
+        level = node_level;
+    }
+
+    Node* inserted = node.get();
+    for (int i = 0; i < node_level; i++) {
+        inserted->levels[i].next = update[i]->levels[i].next;
+        update[i]->levels[i].next = inserted;
+        inserted->levels[i].span = update[i]->levels[i].span - (rank[0] - rank[i]);
+        update[i]->levels[i].span = (rank[0] - rank[i]) + 1;
+    }
+    for (int i = node_level; i < level; i++) {
+        update[i]->levels[i].span++;
+    }
+    length++;
+
+    uint32_t id = inserted->key.id;
+    if (id >= nodes.size()) {
+        nodes.resize(id + 1);
+    }
+    nodes[id] = std::move(node);
+}
+
+unique_ptr<ReviewIndex::Node> ReviewIndex::erase(uint32_t id) {
+    if (id >= nodes.size() || !nodes[id]) {
+        return nullptr;
+    }
+
+    Node* target = nodes[id].get();
+    Node* update[MAX_LEVEL];
+    Node* x = head.get();
+    for (int i = level - 1; i >= 0; i--) {
+        while (x->levels[i].next && less(x->levels[i].next->key, target->key)) {
+            x = x->levels[i].next;
+        }
+        update[i] = x;
+    }
+
+    for (int i = 0; i < level; i++) {
+        if (update[i]->levels[i].next == target) {
+            update[i]->levels[i].span += target->levels[i].span - 1;
+            update[i]->levels[i].next = target->levels[i].next;
+        } else {
+            update[i]->levels[i].span--;
+        }
+    }
+    while (level > 1 && !head->levels[level - 1].next) {
+        level--;
+    }
+    length--;
+
+    for (Level& node_level : target->levels) {
+        node_level = Level();
+    }
+    return std::move(nodes[id]);
+}
+
+void ReviewIndex::clear() {
+    nodes.clear();
+    for (Level& head_level : head->levels) {
+        head_level = Level();
+    }
+    level = 1;
+    length = 0;
+    level_count = 0;
+}
+
+size_t ReviewIndex::size() const {
+    return length;
+}
+
+size_t ReviewIndex::memory_usage() const {
+    return sizeof(ReviewIndex) + nodes.capacity() * sizeof(unique_ptr<Node>) +
+           length * sizeof(Node) + level_count * sizeof(Level) + MAX_LEVEL * sizeof(Level);
+}
+
+const ReviewIndex::Node* ReviewIndex::node_at(size_t rank) const {
+    // 名次从1开始，头节点为0
+    size_t traversed = 0;
+    const Node* x = head.get();
+    for (int i = level - 1; i >= 0; i--) {
+        while (x->levels[i].next && traversed + x->levels[i].span <= rank) {
+            traversed += x->levels[i].span;
+            x = x->levels[i].next;
+        }
+        if (traversed == rank) {
+            return x;
+        }
+    }
+    return nullptr;
+}
+
+vector<uint32_t> ReviewIndex::range(size_t start, size_t count) const {
+    vector<uint32_t> ids;
+    if (start >= length || count == 0) {
+        return ids;
+    }
+
+    ids.reserve(min(count, length - start));
+    for (const Node* node = node_at(start + 1); node && ids.size() < count; node = node->levels[0].next) {
+        ids.push_back(node->key.id);
+    }
+    return ids;
+}
@@ -0,0 +1,206 @@
+#include "ServerConfig.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+namespace {
+
+/**
+ * @brief 解析命令行中的非负整数（stoul 会把 "-1" 转成 SIZE_MAX，这里只接受数字）
+ */
+size_t parse_count(const string& value) {
+    if (value.empty() || value.find_first_not_of("0123456789") != string::npos) {
+        throw invalid_argument(value);
+    }
+    return stoull(value);
+}
+
+/**
+ * @brief 解析命令行中的开关（on/off、true/false、1/0）
+ */
+bool parse_flag(const string& value) {
+    if (value == "on" || value == "true" || value == "1") {
+        return true;
+    }
+    if (value == "off" || value == "false" || value == "0") {
+        return false;
+    }
+    throw invalid_argument(value);
+}
+
+/**
+ * @brief 读取配置文件中的非负整数，负数与小数视为错误
+ */
+void read_count(const json& config, const char* key, size_t& field) {
+    auto it = config.find(key);
+    if (it == config.end()) {
+        return;
+    }
+    if (!it->is_number_unsigned()) {
+        throw invalid_argument(string(key) + " must be a non-negative integer");
+    }
+    field = it->get<size_t>();
+}
+
+}
+
+ServerConfig::ServerConfig() {
+    unsigned cores = thread::hardware_concurrency();
+    threads = max(8u, cores > 0 ? cores - 1 : 0u);
+}
+
+bool ServerConfig::load_file(const string& path) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        cerr << "Error: Cannot open config file " << path << endl;
+        return false;
+    }
+    
+    try {
+        json config;
+        file >> config;
+        host = config.value("host", host);
+        port = config.value("port", port);
+        read_count(config, "threads", threads);
+        read_count(config, "max_queue", max_queue);
+        read_count(config, "spare_threads", spare_threads);
+        read_count(config, "tts_workers", tts_workers);
+        read_count(config, "tts_queue", tts_queue);
+        audio_pack = config.value("audio_pack", audio_pack);
+        reader_socket = config.value("reader_socket", reader_socket);
+        dictionary_url = config.value("dictionary_url", dictionary_url);
+        dictionary_connect_timeout_ms = config.value("dictionary_connect_timeout_ms", dictionary_connect_timeout_ms);
+        dictionary_read_timeout_ms = config.value("dictionary_read_timeout_ms", dictionary_read_timeout_ms);
+        read_count(config, "dictionary_connections", dictionary_connections);
+        debug_routes = config.value("debug_routes", debug_routes);
+    } catch (const exception& e) {
+        cerr << "Error parsing config file " << path << ": " << e.what() << endl;
+        return false;
+    }
+    
+    string error = validate();
+    if (!error.empty()) {
+        cerr << "Error: Invalid config in " << path << ": " << error << endl;
+        return false;
+    }
+    return true;
+}
+
+string ServerConfig::validate() const {
+    if (port <= 0 || port > 65535) {
+        return "port must be 1-65535";
+    }
+    if (threads == 0 || threads > MAX_THREADS) {
+        return "threads must be 1-" + to_string(MAX_THREADS);
+    }
+    if (spare_threads > MAX_THREADS) {
+        return "spare_threads must be at most " + to_string(MAX_THREADS);
+    }
+    if (tts_workers == 0 || tts_workers > MAX_TTS_WORKERS) {
+        return "tts_workers must be 1-" + to_string(MAX_TTS_WORKERS);
+    }
+    if (dictionary_connect_timeout_ms <= 0 || dictionary_read_timeout_ms <= 0) {
+        return "dictionary timeouts must be positive";
+    }
+    if (dictionary_connections == 0 || dictionary_connections > MAX_DICTIONARY_CONNECTIONS) {
+        return "dictionary_connections must be 1-" + to_string(MAX_DICTIONARY_CONNECTIONS);
+    }
+    return "";
+}
+
+bool ServerConfig::parse_args(int argc, char* argv[]) {
+    // 配置文件作为基础，命令行参数无论先后都覆盖文件中的值
+    for (int i = 1; i + 1 < argc; i++) {
+        if (string(argv[i]) == "--config" && !load_file(argv[i + 1])) {
+            return false;
+        }
+    }
+    
+    for (int i = 1; i < argc; i++) {
+        string name = argv[i];
+        if (name == "--help" || name == "-h") {
+            help = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            cerr << "Error: Missing value for " << name << endl;
+            return false;
+        }
+        string value = argv[++i];
+        
+        try {
+            if (name == "--config") {
+                continue;
+            } else if (name == "--host") {
+                host = value;
+            } else if (name == "--port") {
+                port = stoi(value);
+            } else if (name == "--threads") {
+                threads = parse_count(value);
+            } else if (name == "--max-queue") {
+                max_queue = parse_count(value);
+            } else if (name == "--spare-threads") {
+                spare_threads = parse_count(value);
+            } else if (name == "--tts-workers") {
+                tts_workers = parse_count(value);
+            } else if (name == "--tts-queue") {
+                tts_queue = parse_count(value);
+            } else if (name == "--audio-pack") {
+                audio_pack = value;
+            } else if (name == "--reader-socket") {
+                reader_socket = value;
+            } else if (name == "--dictionary-url") {
+                dictionary_url = value;
+            } else if (name == "--dictionary-connect-timeout-ms") {
+                dictionary_connect_timeout_ms = stoi(value);
+            } else if (name == "--dictionary-read-timeout-ms") {
+                dictionary_read_timeout_ms = stoi(value);
+            } else if (name == "--dictionary-connections") {
+                dictionary_connections = parse_count(value);
+            } else if (name == "--debug-routes") {
+                debug_routes = parse_flag(value);
+            } else {
+                cerr << "Error: Unknown option " << name << endl;
+                return false;
+            }
+        } catch (const exception&) {
+            cerr << "Error: Invalid value for " << name << ": " << value << endl;
+            return false;
+        }
+    }
+    
+    string error = validate();
+    if (!error.empty()) {
+        cerr << "Error: Invalid options: " << error << endl;
+        return false;
+    }
+    return true;
+}
+
+string ServerConfig::usage(const string& program) {
+    ServerConfig defaults;
+    return "Usage: " + program + " [options]\n"
+           "  --config <file>          JSON config file (keys: host, port, threads, max_queue, spare_threads,\n"
+           "                           tts_workers, tts_queue, audio_pack, reader_socket, dictionary_url,\n"
+           "                           dictionary_connect_timeout_ms, dictionary_read_timeout_ms, dictionary_connections,\n"
+           "                           debug_routes)\n"
+           "  --host <address>         bind address (default " + defaults.host + ")\n"
+           "  --port <port>            listen port (default " + to_string(defaults.port) + ")\n"
+           "  --threads <n>            request worker threads (default " + to_string(defaults.threads) + ")\n"
+           "  --max-queue <n>          pending connection limit, 0 = unbounded (default " + to_string(defaults.max_queue) + ")\n"
+           "  --spare-threads <n>      extra threads while slow handlers block workers (default " + to_string(defaults.spare_threads) + ")\n"
+           "  --tts-workers <n>        speech synthesis workers (default " + to_string(defaults.tts_workers) + ")\n"
+           "  --tts-queue <n>          pending speech job limit (default " + to_string(defaults.tts_queue) + ")\n"
+           "  --audio-pack <file>      pre-rendered word audio built by audio_pack_builder (default " + defaults.audio_pack + ")\n"
+           "  --reader-socket <path>   forward /speak to a word_reader --daemon on this socket\n"
+           "  --dictionary-url <url>   online dictionary base URL, e.g. http://127.0.0.1:9000 for a local stub\n"
+           "  --dictionary-connect-timeout-ms <ms>  (default " + to_string(defaults.dictionary_connect_timeout_ms) + ")\n"
+           "  --dictionary-read-timeout-ms <ms>     (default " + to_string(defaults.dictionary_read_timeout_ms) + ")\n"
+           "  --dictionary-connections <n>          keep-alive connections to the dictionary (default " + to_string(defaults.dictionary_connections) + ")\n"
+           "  --debug-routes <on|off>  serve /debug/* statistics routes; they need no login (default off)\n"
+           "  --help                   show this help\n";
+}
@@ -0,0 +1,134 @@
+#include "ShardExecutor.h"
+
+ShardExecutor::Shard::Shard() : head(new Node()), tail(head.load()) {}
+
+ShardExecutor::Shard::~Shard() {
+    while (tail) {
+        Node* next = tail->next.load();
+        delete tail;
+        tail = next;
+    }
+}
+
+ShardExecutor::ShardExecutor(size_t shard_count)
+    : count(shard_count > 0 ? shard_count : 1), shards(new Shard[count]) {
+    for (size_t i = 0; i < count; i++) {
+        shards[i].worker = thread(&ShardExecutor::run_shard, this, ref(shards[i]));
+    }
+}
+
+ShardExecutor::~ShardExecutor() {
+    stop();
+}
+
+size_t ShardExecutor::shard_of(const string& key) const {
+    return hash<string>()(key) % count;
+}
+
+size_t ShardExecutor::shard_count() const {
+    return count;
+}
+
+void ShardExecutor::stop() {
+    stopping.store(true);
+    for (size_t i = 0; i < count; i++) {
+        {
+            lock_guard<mutex> lock(shards[i].wakeup_mutex);
+        }
+        shards[i].wakeup.notify_one();
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (shards[i].worker.joinable()) {
+            shards[i].worker.join();
+        }
+    }
+    stopped.store(true);
+}
+
+void ShardExecutor::post(Shard& shard, function<void()> task) {
+    Node* node = new Node();
+    node->task = std::move(task);
+
+    int64_t depth = shard.depth.fetch_add(1, memory_order_relaxed) + 1;
+    int64_t max_depth = shard.max_depth.load(memory_order_relaxed);
+    while (depth > max_depth && !shard.max_depth.compare_exchange_weak(max_depth, depth, memory_order_relaxed)) {
+    }
+
+    // 交换 head 后再链接前驱；链接完成前消费者只会把队列看成空的
+    Node* previous = shard.head.exchange(node);
+    previous->next.store(node);
+
+    // 与工作线程"先标记休眠再检查队列"配对，两边都用顺序一致的原子操作，不会丢失唤醒
+    if (shard.sleeping.load()) {
+        lock_guard<mutex> lock(shard.wakeup_mutex);
+        shard.wakeup.notify_one();
+    }
+}
+
+bool ShardExecutor::pop(Shard& shard, function<void()>& task) {
+    Node* sentinel = shard.tail;
+    Node* next = sentinel->next.load();
+    if (!next) {
+        return false;
+    }
+    // 取出的节点成为新的哨兵
+    task = std::move(next->task);
+    shard.tail = next;
+    delete sentinel;
+    shard.depth.fetch_sub(1, memory_order_relaxed);
+    return true;
+}
+
+void ShardExecutor::run_shard(Shard& shard) {
+    current_shard = &shard;
+    function<void()> task;
+    while (true) {
+        uint64_t executed = 0;
+        while (pop(shard, task)) {
+            task();
+            task = nullptr;
+            executed++;
+        }
+        if (executed > 0) {
+            shard.tasks.fetch_add(executed, memory_order_relaxed);
+            shard.bursts.fetch_add(1, memory_order_relaxed);
+        }
+
+        unique_lock<mutex> lock(shard.wakeup_mutex);
+        shard.sleeping.store(true);
+        shard.wakeup.wait(lock, [this, &shard] { return stopping.load() || shard.tail->next.load(); });
+        shard.sleeping.store(false);
+        if (stopping.load() && !shard.tail->next.load()) {
+            break;
+        }
+    }
+}
+
+json ShardExecutor::get_stats() const {
+    json shard_stats = json::array();
+    uint64_t total_tasks = 0;
+    uint64_t total_bursts = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t tasks = shards[i].tasks.load(memory_order_relaxed);
+        uint64_t bursts = shards[i].bursts.load(memory_order_relaxed);
+        total_tasks += tasks;
+        total_bursts += bursts;
+        if (tasks == 0) {
+            continue;
+        }
+        shard_stats.push_back({
+            {"shard", i},
+            {"tasks", tasks},
+            {"bursts", bursts},
+            {"queue_depth", shards[i].depth.load(memory_order_relaxed)},
+            {"max_queue_depth", shards[i].max_depth.load(memory_order_relaxed)}
+        });
+    }
+    return {
+        {"shard_count", count},
+        {"tasks", total_tasks},
+        {"bursts", total_bursts},
+        {"tasks_per_burst", total_bursts > 0 ? (double)total_tasks / total_bursts : 0.0},
+        {"shards", shard_stats}
+    };
+}
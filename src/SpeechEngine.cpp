@@ -0,0 +1,267 @@
+#include "SpeechEngine.h"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#ifdef WORD_APP_HAVE_ESPEAK_NG
+#include <espeak-ng/speak_lib.h>
+#endif
+
+extern char** environ;
+
+namespace {
+
+template <typename T>
+void put(string& out, T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T get(const string& in, size_t offset) {
+    T value;
+    memcpy(&value, in.data() + offset, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief 在 PATH 中查找可执行程序
+ */
+string find_program(const string& name) {
+    const char* path = getenv("PATH");
+    stringstream dirs(path ? path : "/usr/local/bin:/usr/bin:/bin");
+    string dir;
+    while (getline(dirs, dir, ':')) {
+        string candidate = (dir.empty() ? "." : dir) + "/" + name;
+        if (access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return "";
+}
+
+#ifdef WORD_APP_HAVE_ESPEAK_NG
+/**
+ * @brief espeak-ng 合成回调，把样本追加到 espeak_Synth 传入的缓冲区
+ */
+int collect_samples(short* wav, int count, espeak_EVENT* events) {
+    if (wav && count > 0) {
+        auto* samples = static_cast<vector<int16_t>*>(events->user_data);
+        samples->insert(samples->end(), wav, wav + count);
+    }
+    return 0;
+}
+#endif
+
+}
+
+SpeechEngine& SpeechEngine::instance() {
+    static SpeechEngine engine;
+    return engine;
+}
+
+SpeechEngine::SpeechEngine() {
+#ifdef WORD_APP_HAVE_ESPEAK_NG
+    // 同步模式：espeak_Synth 返回时样本已全部通过回调交出
+    int library_rate = espeak_Initialize(AUDIO_OUTPUT_SYNCHRONOUS, 0, nullptr, 0);
+    if (library_rate > 0) {
+        espeak_SetSynthCallback(collect_samples);
+        espeak_SetVoiceByName("en");
+        rate = library_rate;
+        library_ready = true;
+        return;
+    }
+    cerr << "Warning: Cannot initialize libespeak-ng, falling back to espeak program" << endl;
+#endif
+    
+    for (const char* name : {"espeak-ng", "espeak"}) {
+        espeak_program = find_program(name);
+        if (!espeak_program.empty()) {
+            break;
+        }
+    }
+    if (espeak_program.empty()) {
+        cerr << "Warning: No TTS engine found. Please install espeak-ng or espeak." << endl;
+    }
+}
+
+SpeechEngine::~SpeechEngine() {
+#ifdef WORD_APP_HAVE_ESPEAK_NG
+    if (library_ready) {
+        espeak_Terminate();
+    }
+#endif
+}
+
+bool SpeechEngine::available() const {
+    return library_ready || !espeak_program.empty();
+}
+
+string SpeechEngine::backend() const {
+    if (library_ready) {
+        return "libespeak-ng";
+    }
+    return espeak_program.empty() ? "none" : "espeak --stdout";
+}
+
+int SpeechEngine::sample_rate() const {
+    return rate;
+}
+
+bool SpeechEngine::synthesize(const string& text, int speed, vector<int16_t>& samples) {
+#ifdef WORD_APP_HAVE_ESPEAK_NG
+    if (library_ready) {
+        lock_guard<mutex> lock(synth_mutex);
+        espeak_SetParameter(espeakRATE, speed, 0);
+        espeak_ERROR error = espeak_Synth(text.c_str(), text.size() + 1, 0, POS_CHARACTER, 0,
+                                          espeakCHARS_UTF8, nullptr, &samples);
+        return error == EE_OK;
+    }
+#endif
+    if (espeak_program.empty()) {
+        return false;
+    }
+    return synthesize_with_program(text, speed, samples);
+}
+
+bool SpeechEngine::synthesize_with_program(const string& text, int speed, vector<int16_t>& samples) const {
+    // 文本从标准输入传入，以 - 开头的单词也不会被当作选项
+    int input[2];
+    int output[2];
+    if (pipe2(input, O_CLOEXEC) != 0) {
+        return false;
+    }
+    if (pipe2(output, O_CLOEXEC) != 0) {
+        close(input[0]);
+        close(input[1]);
+        return false;
+    }
+    
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, input[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, output[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    
+    string speed_arg = to_string(speed);
+    vector<char*> argv = {
+        const_cast<char*>(espeak_program.c_str()),
+        const_cast<char*>("--stdout"),
+        const_cast<char*>("-s"),
+        const_cast<char*>(speed_arg.c_str()),
+        nullptr
+    };
+    pid_t pid;
+    int error = posix_spawn(&pid, espeak_program.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(input[0]);
+    close(output[1]);
+    if (error != 0) {
+        cerr << "Error: Cannot start " << espeak_program << ": " << strerror(error) << endl;
+        close(input[1]);
+        close(output[0]);
+        return false;
+    }
+    
+    // 单词远小于管道缓冲区，先写完再读不会互相等待
+    string line = text + "\n";
+    bool written = write(input[1], line.data(), line.size()) == (ssize_t)line.size();
+    close(input[1]);
+    
+    string wav;
+    char buffer[65536];
+    ssize_t count;
+    while ((count = read(output[0], buffer, sizeof(buffer))) != 0) {
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        wav.append(buffer, count);
+    }
+    close(output[0]);
+    
+    int status;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    
+    int wav_rate = 0;
+    if (!written || !decode_wav(wav, samples, wav_rate)) {
+        return false;
+    }
+    if (wav_rate != rate) {
+        cerr << "Error: Unexpected sample rate " << wav_rate << " from " << espeak_program << endl;
+        return false;
+    }
+    return true;
+}
+
+string SpeechEngine::encode_wav(const vector<int16_t>& samples, int sample_rate) {
+    uint32_t data_size = samples.size() * sizeof(int16_t);
+    string wav = wav_header(data_size, sample_rate);
+    wav.append(reinterpret_cast<const char*>(samples.data()), data_size);
+    return wav;
+}
+
+string SpeechEngine::wav_header(uint32_t data_size, int sample_rate) {
+    string wav;
+    wav.reserve(44);
+    wav += "RIFF";
+    put<uint32_t>(wav, 36 + data_size);
+    wav += "WAVE";
+    wav += "fmt ";
+    put<uint32_t>(wav, 16);
+    put<uint16_t>(wav, 1);                  // PCM
+    put<uint16_t>(wav, 1);                  // 单声道
+    put<uint32_t>(wav, sample_rate);
+    put<uint32_t>(wav, sample_rate * 2);    // 每秒字节数
+    put<uint16_t>(wav, 2);                  // 每帧字节数
+    put<uint16_t>(wav, 16);                 // 位深
+    wav += "data";
+    put<uint32_t>(wav, data_size);
+    return wav;
+}
+
+bool SpeechEngine::decode_wav(const string& wav, vector<int16_t>& samples, int& sample_rate) {
+    if (wav.size() < 12 || wav.compare(0, 4, "RIFF") != 0 || wav.compare(8, 4, "WAVE") != 0) {
+        return false;
+    }
+    
+    bool format_ok = false;
+    size_t offset = 12;
+    while (offset + 8 <= wav.size()) {
+        string id = wav.substr(offset, 4);
+        uint32_t size = get<uint32_t>(wav, offset + 4);
+        offset += 8;
+        
+        if (id == "fmt ") {
+            if (offset + 16 > wav.size()) {
+                return false;
+            }
+            uint16_t format = get<uint16_t>(wav, offset);
+            uint16_t channels = get<uint16_t>(wav, offset + 2);
+            uint16_t bits = get<uint16_t>(wav, offset + 14);
+            sample_rate = get<uint32_t>(wav, offset + 4);
+            format_ok = format == 1 && channels == 1 && bits == 16;
+        } else if (id == "data") {
+            if (!format_ok) {
+                return false;
+            }
+            size_t available = min<size_t>(size, wav.size() - offset) / sizeof(int16_t);
+            size_t first = samples.size();
+            samples.resize(first + available);
+            memcpy(samples.data() + first, wav.data() + offset, available * sizeof(int16_t));
+            return true;
+        }
+        // 块按偶数字节对齐
+        offset += size + (size & 1);
+    }
+    return false;
+}
@@ -0,0 +1,181 @@
+#include "SpeechJobQueue.h"
+
+SpeechJobQueue::SpeechJobQueue(size_t worker_count, size_t max_pending, const AudioPack* pack,
+                               const string& reader_socket, int speed)
+    : engine(SpeechEngine::instance()), pack(pack), sink(engine.sample_rate()), max_pending(max_pending), speed(speed) {
+    if (!reader_socket.empty()) {
+        reader = make_unique<WordReaderClient>(reader_socket);
+    }
+    for (size_t i = 0; i < max<size_t>(1, worker_count); i++) {
+        workers.emplace_back(&SpeechJobQueue::run_worker, this);
+    }
+}
+
+SpeechJobQueue::~SpeechJobQueue() {
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+uint64_t SpeechJobQueue::submit(const string& word) {
+    uint64_t id;
+    {
+        lock_guard<mutex> lock(jobs_mutex);
+        if (stopping || pending.size() >= max_pending) {
+            rejected_count++;
+            return 0;
+        }
+        id = next_id++;
+        Job& job = jobs[id];
+        job.word = word;
+        job.created = chrono::steady_clock::now();
+        pending.push_back(id);
+    }
+    job_ready.notify_one();
+    return id;
+}
+
+const char* SpeechJobQueue::state_name(State state) {
+    switch (state) {
+        case State::QUEUED: return "queued";
+        case State::RUNNING: return "running";
+        case State::DONE: return "done";
+        case State::FAILED: return "failed";
+    }
+    return "unknown";
+}
+
+bool SpeechJobQueue::get_status(uint64_t id, json& status) const {
+    lock_guard<mutex> lock(jobs_mutex);
+    auto it = jobs.find(id);
+    if (it == jobs.end()) {
+        return false;
+    }
+    
+    const Job& job = it->second;
+    auto elapsed_ms = [](chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+        return chrono::duration_cast<chrono::milliseconds>(to - from).count();
+    };
+    auto now = chrono::steady_clock::now();
+    status = {
+        {"id", id},
+        {"word", job.word},
+        {"state", state_name(job.state)}
+    };
+    if (job.state == State::QUEUED) {
+        status["queued_ms"] = elapsed_ms(job.created, now);
+    } else {
+        status["queued_ms"] = elapsed_ms(job.created, job.started);
+        status["run_ms"] = elapsed_ms(job.started, job.state == State::RUNNING ? now : job.finished);
+    }
+    if (job.state == State::DONE) {
+        status["audio_ms"] = job.audio_ms;
+    } else if (job.state == State::FAILED) {
+        status["error"] = job.error;
+    }
+    return true;
+}
+
+json SpeechJobQueue::get_stats() const {
+    lock_guard<mutex> lock(jobs_mutex);
+    return {
+        {"backend", engine.backend()},
+        {"workers", workers.size()},
+        {"max_pending", max_pending},
+        {"pending", pending.size()},
+        {"running", running},
+        {"completed", completed_count},
+        {"failed", failed_count},
+        {"rejected", rejected_count},
+        {"pack_words", pack && pack->is_open() ? pack->size() : 0},
+        {"pack_hits", pack_hits.load()},
+        {"reader_socket", reader ? reader->path() : ""},
+        {"forwarded", forwarded.load()}
+    };
+}
+
+void SpeechJobQueue::run_worker() {
+    unique_lock<mutex> lock(jobs_mutex);
+    while (true) {
+        job_ready.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (stopping) {
+            break;
+        }
+        
+        uint64_t id = pending.front();
+        pending.pop_front();
+        Job& job = jobs[id];
+        job.state = State::RUNNING;
+        job.started = chrono::steady_clock::now();
+        string word = job.word;
+        running++;
+        
+        lock.unlock();
+        string error;
+        size_t audio_ms = 0;
+        bool spoken = speak(word, error, audio_ms);
+        lock.lock();
+        
+        // 任务在执行期间不会被清理，引用仍然有效
+        running--;
+        job.error = error;
+        job.audio_ms = audio_ms;
+        job.finished = chrono::steady_clock::now();
+        if (spoken) {
+            job.state = State::DONE;
+            completed_count++;
+        } else {
+            job.state = State::FAILED;
+            failed_count++;
+        }
+        
+        finished.push_back(id);
+        while (finished.size() > MAX_FINISHED) {
+            jobs.erase(finished.front());
+            finished.pop_front();
+        }
+    }
+}
+
+bool SpeechJobQueue::speak(const string& word, string& job_error, size_t& audio_ms) {
+    // 守护进程排队后立即回复；连不上时回退到本地播放
+    string reply;
+    if (reader && reader->request("speak " + word, reply)) {
+        if (reply.compare(0, 2, "ok") != 0) {
+            job_error = "word_reader: " + reply;
+            return false;
+        }
+        forwarded++;
+        return true;
+    }
+    
+    // 音频包与输出采样率一致时直接播放映射内存，不合成也不复制
+    string_view clip = pack && pack->sample_rate() == engine.sample_rate() ? pack->find(word) : string_view();
+    if (!clip.empty()) {
+        pack_hits++;
+        size_t count = (clip.size() - AudioPack::WAV_HEADER_SIZE) / sizeof(int16_t);
+        audio_ms = count * 1000 / engine.sample_rate();
+        if (!sink.play(reinterpret_cast<const int16_t*>(clip.data() + AudioPack::WAV_HEADER_SIZE), count)) {
+            job_error = "Audio output failed";
+            return false;
+        }
+        return true;
+    }
+    
+    vector<int16_t> samples;
+    if (!engine.synthesize(word, speed, samples)) {
+        job_error = engine.available() ? "Speech synthesis failed" : "No TTS engine available";
+        return false;
+    }
+    audio_ms = samples.size() * 1000 / engine.sample_rate();
+    if (!sink.play(samples)) {
+        job_error = "Audio output failed";
+        return false;
+    }
+    return true;
+}
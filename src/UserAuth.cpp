@@ -1,24 +1,32 @@
 #include "UserAuth.h"
 #include "FileUtils.h"
+#include "UserProgressLog.h"
 #include <fstream>
 #include <iostream>
 #include <filesystem>
 #include <ctime>
 #include <algorithm>
 #include <regex>
+#include <random>
+#include <sstream>
+#include <iomanip>
 
 namespace fs = std::filesystem;
 
-UserAuth::UserAuth() : current_user("") {
+UserAuth::UserAuth() : catalog(VocabularyCatalog::instance()) {
     // 生产环境配置
     if (getenv("PRODUCTION")) {
         USERS_DIR = "/var/www/word-app/users/";
-        WORDS_FILE = "/var/www/word-app/data/words.txt";
     } else {
         USERS_DIR = "data/users/";
-        WORDS_FILE = "data/words.txt";
     }
     
+    session_idle_seconds = 7 * 24 * 3600;
+    if (getenv("SESSION_IDLE_SECONDS")) {
+        session_idle_seconds = max(1L, atol(getenv("SESSION_IDLE_SECONDS")));
+    }
+    progress_file = make_unique<UserProgressFile>(USERS_DIR, catalog);
+    
     // 确保用户数据目录存在
     try {
         fs::create_directories(USERS_DIR);
@@ -31,16 +39,67 @@ UserAuth::UserAuth() : current_user("") {
 
 UserAuth::~UserAuth() {
     // 清理会话信息
+    unique_lock<shared_mutex> lock(sessions_mutex);
     active_sessions.clear();
 }
 
-string UserAuth::get_user_data_file(const string& username) {
-    return USERS_DIR + username + ".json";
+string UserAuth::generate_token() {
+    static random_device device;
+    static mutex device_mutex;
+    lock_guard<mutex> lock(device_mutex);
+    
+    ostringstream token;
+    token << hex << setfill('0');
+    for (int i = 0; i < 4; i++) {
+        token << setw(8) << (uint32_t)device();
+    }
+    return token.str();
+}
+
+bool UserAuth::is_expired(const Session& session, time_t now) const {
+    return now - session.last_seen.load(memory_order_relaxed) > session_idle_seconds;
+}
+
+void UserAuth::sweep_expired_sessions(time_t now) {
+    if (now - last_sweep < max<time_t>(session_idle_seconds / 10, 1)) {
+        return;
+    }
+    last_sweep = now;
+    
+    for (auto it = active_sessions.begin(); it != active_sessions.end();) {
+        if (is_expired(it->second, now)) {
+            it = active_sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t UserAuth::revoke_sessions(const string& username) {
+    unique_lock<shared_mutex> lock(sessions_mutex);
+    size_t revoked = 0;
+    for (auto it = active_sessions.begin(); it != active_sessions.end();) {
+        if (it->second.username == username) {
+            it = active_sessions.erase(it);
+            revoked++;
+        } else {
+            ++it;
+        }
+    }
+    return revoked;
 }
 
 bool UserAuth::user_exists(const string& username) {
-    string user_file = get_user_data_file(username);
-    return fs::exists(user_file);
+    return progress_file->exists(username);
+}
+
+mutex& UserAuth::account_mutex(const string& username) {
+    lock_guard<mutex> lock(account_registry_mutex);
+    auto& entry = account_locks[username];
+    if (!entry) {
+        entry = make_unique<mutex>();
+    }
+    return *entry;
 }
 
 bool UserAuth::is_valid_username(const string& username) {
@@ -55,17 +114,16 @@ bool UserAuth::is_valid_username(const string& username) {
 
 bool UserAuth::create_user_data(const string& username) {
     try {
-        ifstream words_file(WORDS_FILE);
-        if (!words_file.is_open()) {
-            cerr << "Error: Cannot open " << WORDS_FILE << endl;
+        if (catalog.size() == 0) {
+            cerr << "Error: Vocabulary is empty" << endl;
             return false;
         }
         
         // 创建用户数据结构
-        json user_data = json::object();
+        UserProgress progress(catalog);
         
         // 用户信息
-        user_data["user_info"] = {
+        progress.user_info = {
             {"username", username},
             {"created_at", time(nullptr)},
             {"last_login", time(nullptr)},
@@ -74,33 +132,14 @@ bool UserAuth::create_user_data(const string& username) {
             {"total_learning_time", 0}
         };
         
-        // 单词数据
-        user_data["words"] = json::object();
-        string word;
-        while (getline(words_file, word)) {
-            if (!word.empty()) {
-                // 移除可能的回车符
-                word.erase(word.find_last_not_of(" \n\r\t") + 1);
-                user_data["words"][word] = {
-                    {"mistakes", 0},
-                    {"correct_count", 0},
-                    {"last_seen", 0}
-                };
-            }
-        }
-        words_file.close();
+        // 单词数据：新用户所有单词计数为0
         
         // 保存用户数据文件
-        string user_file = get_user_data_file(username);
-        ofstream data_file(user_file);
-        if (!data_file.is_open()) {
-            cerr << "Error: Cannot create user file " << user_file << endl;
+        if (!progress_file->save(username, progress)) {
+            cerr << "Error: Cannot create user file " << progress_file->get_data_file(username) << endl;
             return false;
         }
         
-        data_file << user_data.dump(4);
-        data_file.close();
-        
         cout << "✓ Created new user: " << username << endl;
         return true;
         
@@ -118,8 +157,12 @@ json UserAuth::login(const string& username) {
         };
     }
     
+    // 创建用户与登记会话要和删除同名用户互斥，否则删除可能发生在两者之间
+    lock_guard<mutex> account_lock(account_mutex(username));
+    
     // 检查用户是否存在，不存在则自动创建
-    if (!user_exists(username)) {
+    bool is_new_user = !user_exists(username);
+    if (is_new_user) {
         if (!create_user_data(username)) {
             return {
                 {"success", false},
@@ -128,24 +171,21 @@ json UserAuth::login(const string& username) {
         }
     }
     
-    // 设置当前用户
-    current_user = username;
-    
-    // 更新最后登录时间
-    update_last_login(username);
-    
-    // 创建会话信息
-    active_sessions[username] = {
-        {"login_time", time(nullptr)},
-        {"session_id", username + "_" + to_string(time(nullptr))}
-    };
+    // 创建会话，同一用户可以同时有多个会话（例如多个浏览器）
+    string token = generate_token();
+    {
+        unique_lock<shared_mutex> lock(sessions_mutex);
+        time_t now = time(nullptr);
+        sweep_expired_sessions(now);
+        active_sessions.try_emplace(token, username, now);
+    }
     
     return {
         {"success", true},
         {"message", "Login successful"},
         {"username", username},
-        {"session_id", active_sessions[username]["session_id"]},
-        {"is_new_user", !user_exists(username)}
+        {"session_token", token},
+        {"is_new_user", is_new_user}
     };
 }
 
@@ -157,6 +197,7 @@ json UserAuth::register_user(const string& username) {
         };
     }
     
+    lock_guard<mutex> account_lock(account_mutex(username));
     if (user_exists(username)) {
         return {
             {"success", false},
@@ -178,70 +219,91 @@ json UserAuth::register_user(const string& username) {
     }
 }
 
-string UserAuth::get_current_user() const {
-    return current_user;
+string UserAuth::resolve_session(const string& token) const {
+    shared_lock<shared_mutex> lock(sessions_mutex);
+    auto it = active_sessions.find(token);
+    time_t now = time(nullptr);
+    if (it == active_sessions.end() || is_expired(it->second, now)) {
+        return "";
+    }
+    
+    // 过期会话留给登录时的清理删除，这里只需共享锁
+    it->second.last_seen.store(now, memory_order_relaxed);
+    return it->second.username;
+}
+
+bool UserAuth::has_active_session(const string& username) const {
+    shared_lock<shared_mutex> lock(sessions_mutex);
+    time_t now = time(nullptr);
+    for (const auto& [token, session] : active_sessions) {
+        if (session.username == username && !is_expired(session, now)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-json UserAuth::get_current_user_info() {
-    if (current_user.empty()) {
+json UserAuth::get_user_info(const string& username) {
+    if (username.empty()) {
         return {
             {"success", false},
             {"error", "No user logged in"}
         };
     }
     
-    string user_file = get_user_data_file(current_user);
-    ifstream file(user_file);
-    if (!file.is_open()) {
+    json user_info;
+    if (!progress_file->load_info(username, user_info)) {
         return {
             {"success", false},
             {"error", "Cannot load user data"}
         };
     }
     
-    json user_data;
-    file >> user_data;
-    file.close();
-    
     return {
         {"success", true},
-        {"username", current_user},
-        {"user_info", user_data["user_info"]},
-        {"session_active", active_sessions.find(current_user) != active_sessions.end()}
+        {"username", username},
+        {"user_info", user_info},
+        {"session_active", has_active_session(username)}
     };
 }
 
-json UserAuth::switch_user(const string& username) {
-    if (username == current_user) {
+json UserAuth::switch_user(const string& token, const string& username) {
+    string previous_user = resolve_session(token);
+    if (!previous_user.empty() && username == previous_user) {
         return {
             {"success", true},
-            {"message", "Already logged in as " + username}
+            {"message", "Already logged in as " + username},
+            {"username", username},
+            {"session_token", token}
         };
     }
     
-    // 登出当前用户
-    if (!current_user.empty()) {
-        logout();
+    // 登录新用户，成功后再结束原会话
+    json result = login(username);
+    if (result["success"].get<bool>() && !previous_user.empty()) {
+        logout(token);
+        result["previous_user"] = previous_user;
     }
-    
-    // 登录新用户
-    return login(username);
+    return result;
 }
 
-json UserAuth::logout() {
-    if (current_user.empty()) {
-        return {
-            {"success", false},
-            {"error", "No user logged in"}
-        };
+json UserAuth::logout(const string& token) {
+    string logged_out_user;
+    {
+        unique_lock<shared_mutex> lock(sessions_mutex);
+        auto it = active_sessions.find(token);
+        if (it == active_sessions.end()) {
+            return {
+                {"success", false},
+                {"error", "No user logged in"}
+            };
+        }
+        logged_out_user = it->second.username;
+        
+        // 清除会话
+        active_sessions.erase(it);
     }
     
-    string logged_out_user = current_user;
-    
-    // 清除会话
-    active_sessions.erase(current_user);
-    current_user = "";
-    
     return {
         {"success", true},
         {"message", "Logged out successfully"},
@@ -249,28 +311,20 @@ json UserAuth::logout() {
     };
 }
 
-json UserAuth::get_user_list() {
+json UserAuth::get_user_list(const string& username) {
     vector<json> users;
     
     try {
-        for (const auto& entry : fs::directory_iterator(USERS_DIR)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".json") {
-                string username = entry.path().stem().string();
-                
-                // 读取用户信息
-                ifstream file(entry.path());
-                if (file.is_open()) {
-                    json user_data;
-                    file >> user_data;
-                    file.close();
-                    
-                    users.push_back({
-                        {"username", username},
-                        {"created_at", user_data["user_info"]["created_at"]},
-                        {"last_login", user_data["user_info"]["last_login"]},
-                        {"is_current", username == current_user}
-                    });
-                }
+        for (const string& name : progress_file->list_users()) {
+            // 只读取用户信息，不解码单词记录
+            json user_info;
+            if (progress_file->load_info(name, user_info)) {
+                users.push_back({
+                    {"username", name},
+                    {"created_at", user_info["created_at"]},
+                    {"last_login", user_info["last_login"]},
+                    {"is_current", name == username}
+                });
             }
         }
         
@@ -290,18 +344,12 @@ json UserAuth::get_user_list() {
         {"success", true},
         {"users", users},
         {"total_users", users.size()},
-        {"current_user", current_user}
+        {"current_user", username}
     };
 }
 
-json UserAuth::delete_user(const string& username) {
-    if (username == current_user) {
-        return {
-            {"success", false},
-            {"error", "Cannot delete currently logged in user"}
-        };
-    }
-    
+json UserAuth::delete_user(const string& username, const function<void()>& release) {
+    lock_guard<mutex> account_lock(account_mutex(username));
     if (!user_exists(username)) {
         return {
             {"success", false},
@@ -309,14 +357,25 @@ json UserAuth::delete_user(const string& username) {
         };
     }
     
+    // 持有账户锁期间不会有新的登录，结束现有会话后该用户的令牌全部失效
+    size_t revoked_sessions = revoke_sessions(username);
+    
+    // 再释放内存中的状态，之后不会再有该用户的记录写回
+    if (release) {
+        release();
+    }
+    
     try {
-        string user_file = get_user_data_file(username);
-        fs::remove(user_file);
+        // 压缩在快照锁内读快照、写快照，删除必须等它结束
+        lock_guard<mutex> snapshot_lock(UserProgressLog::snapshot_mutex(username));
+        progress_file->remove(username);
+        UserProgressLog(USERS_DIR, catalog).remove(username);
         
         return {
             {"success", true},
             {"message", "User deleted successfully"},
-            {"deleted_user", username}
+            {"deleted_user", username},
+            {"revoked_sessions", revoked_sessions}
         };
     } catch (const fs::filesystem_error& e) {
         return {
@@ -326,25 +385,9 @@ json UserAuth::delete_user(const string& username) {
     }
 }
 
-void UserAuth::update_last_login(const string& username) {
-    string user_file = get_user_data_file(username);
-    ifstream file(user_file);
-    if (!file.is_open()) return;
-    
-    json user_data;
-    file >> user_data;
-    file.close();
-    
-    user_data["user_info"]["last_login"] = time(nullptr);
-    user_data["user_info"]["total_sessions"] = user_data["user_info"]["total_sessions"].get<int>() + 1;
-    
-    ofstream out_file(user_file);
-    out_file << user_data.dump(4);
-    out_file.close();
-}
-
-json UserAuth::get_user_stats(const string& username) {
-    string target_user = username.empty() ? current_user : username;
+json UserAuth::get_user_stats(const string& username,
+                              const function<bool(ProgressTotals& totals, json& user_info)>& resident) {
+    const string& target_user = username;
     
     if (target_user.empty()) {
         return {
@@ -353,31 +396,31 @@ json UserAuth::get_user_stats(const string& username) {
         };
     }
     
-    string user_file = get_user_data_file(target_user);
-    ifstream file(user_file);
-    if (!file.is_open()) {
-        return {
-            {"success", false},
-            {"error", "Cannot load user data"}
-        };
+    ProgressTotals totals;
+    json user_info;
+    if (!resident || !resident(totals, user_info)) {
+        UserProgress progress;
+        lock_guard<mutex> snapshot_lock(UserProgressLog::snapshot_mutex(target_user));
+        if (!progress_file->load(target_user, progress)) {
+            return {
+                {"success", false},
+                {"error", "Cannot load user data"}
+            };
+        }
+        
+        // 快照之后的变更还在进度日志中
+        UserProgressLog(USERS_DIR, catalog).replay(target_user, progress.log_seq,
+                                                   [&progress](const UserProgressLog::Record& record) {
+                                                       progress.apply(record);
+                                                   });
+        totals = progress.get_totals();
+        user_info = progress.user_info;
     }
     
-    json user_data;
-    file >> user_data;
-    file.close();
-    
     // 计算统计信息
-    int total_words = user_data["words"].size();
-    int words_with_mistakes = 0;
-    int total_mistakes = 0;
-    
-    for (auto& [word, word_data] : user_data["words"].items()) {
-        int mistakes = word_data["mistakes"].get<int>();
-        if (mistakes > 0) {
-            words_with_mistakes++;
-            total_mistakes += mistakes;
-        }
-    }
+    int total_words = catalog.size();
+    int words_with_mistakes = totals.review_count;
+    int total_mistakes = totals.total_mistakes;
     
     return {
         {"success", true},
@@ -388,9 +431,9 @@ json UserAuth::get_user_stats(const string& username) {
             {"review_needed", words_with_mistakes},
             {"total_mistakes", total_mistakes},
             {"accuracy", total_words > 0 ? (double)(total_words - words_with_mistakes) / total_words * 100 : 0},
-            {"total_sessions", user_data["user_info"]["total_sessions"]},
-            {"created_at", user_data["user_info"]["created_at"]},
-            {"last_login", user_data["user_info"]["last_login"]}
+            {"total_sessions", user_info["total_sessions"]},
+            {"created_at", user_info["created_at"]},
+            {"last_login", user_info["last_login"]}
         }}
     };
 }
@@ -6,97 +6,489 @@
 #include <random>
 #include <filesystem>
 #include <ctime>
+#include <chrono>
 
 namespace fs = std::filesystem;
 
-UserDataManager::UserDataManager() : current_user("") {
+UserDataManager::UserDataManager()
+    : catalog(VocabularyCatalog::instance()),
+      user_locks(getenv("USER_LOCK_SHARDS") ? max(1, atoi(getenv("USER_LOCK_SHARDS"))) : 64),
+      cache_shard_count(user_locks.shard_count()),
+      cache_shards(new CacheShard[cache_shard_count]), cache_budget(64 * 1024 * 1024),
+      progress_log("", catalog),
+      dirty_shards(new DirtyShard[user_locks.shard_count()]),
+      flush_bytes(64 * 1024), flush_interval_ms(1000), stopping(false) {
     // 生产环境配置
     if (getenv("PRODUCTION")) {
         USERS_DIR = "/var/www/word-app/users/";
     } else {
         USERS_DIR = "data/users/";
     }
+    progress_log = UserProgressLog(USERS_DIR, catalog);
+    progress_file = make_unique<UserProgressFile>(USERS_DIR, catalog);
+    compactor = make_unique<ProgressCompactor>(USERS_DIR, *progress_file);
+    compactor->start();
+    
+    // 上下文缓存预算
+    if (getenv("USER_CACHE_BYTES")) {
+        cache_budget = max(0L, atol(getenv("USER_CACHE_BYTES")));
+    }
+    
+    // 写回缓冲配置
+    if (getenv("PROGRESS_FLUSH_INTERVAL_MS")) {
+        flush_interval_ms = max(1, atoi(getenv("PROGRESS_FLUSH_INTERVAL_MS")));
+    }
+    if (getenv("PROGRESS_FLUSH_BYTES")) {
+        flush_bytes = max(1L, atol(getenv("PROGRESS_FLUSH_BYTES")));
+    }
+    flusher = thread(&UserDataManager::run_flusher, this);
 }
 
-string UserDataManager::get_user_data_file(const string& username) {
-    return USERS_DIR + username + ".json";
+UserDataManager::~UserDataManager() {
+    shutdown();
 }
 
-bool UserDataManager::load_user_data(const string& username) {
-    string user_file = get_user_data_file(username);
-    ifstream file(user_file);
-    if (!file.is_open()) {
-        cerr << "Error: Cannot open user data file for " << username << endl;
-        return false;
+void UserDataManager::shutdown() {
+    {
+        lock_guard<mutex> lock(flusher_mutex);
+        stopping = true;
+    }
+    flush_wakeup.notify_all();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    flush();
+}
+
+void UserDataManager::run_flusher() {
+    // 记入缓冲不持有 flusher_mutex，错过的唤醒最多推迟到下一个定期落盘
+    unique_lock<mutex> lock(flusher_mutex);
+    while (!stopping) {
+        flush_wakeup.wait_for(lock, chrono::milliseconds(flush_interval_ms),
+                              [this] { return stopping || dirty_bytes >= flush_bytes; });
+        if (stopping) {
+            break;
+        }
+        if (dirty_bytes == 0) {
+            continue;
+        }
+        
+        lock.unlock();
+        flush();
+        lock.lock();
     }
+}
+
+bool UserDataManager::flush() {
+    // 与 flush_user 互斥：加载用户前必须等正在进行的落盘写完
+    lock_guard<mutex> flush_lock(flush_mutex);
+    
+    bool success = true;
+    for (size_t i = 0; i < user_locks.shard_count(); i++) {
+        // 每次只锁一个分片取走记录，写文件时不持有分片锁
+        DirtyShard& shard = dirty_shards[i];
+        map<string, vector<UserProgressLog::Record>> records;
+        {
+            lock_guard<mutex> lock(shard.shard_mutex);
+            records.swap(shard.records);
+            dirty_bytes -= shard.bytes;
+            shard.bytes = 0;
+        }
+        
+        for (auto& [username, user_records] : records) {
+            if (!progress_log.append(username, user_records)) {
+                requeue(username, user_records);
+                success = false;
+            }
+        }
+    }
+    return success;
+}
+
+bool UserDataManager::flush_user(const string& username) {
+    lock_guard<mutex> flush_lock(flush_mutex);
     
-    try {
-        file >> user_data;
-        file.close();
+    vector<UserProgressLog::Record> records;
+    take_dirty(username, records);
+    if (records.empty()) {
         return true;
-    } catch (const exception& e) {
-        cerr << "Error loading user data: " << e.what() << endl;
+    }
+    
+    if (!progress_log.append(username, records)) {
+        requeue(username, records);
         return false;
     }
+    return true;
 }
 
-bool UserDataManager::save_user_data() {
-    if (current_user.empty()) {
-        return false;
+void UserDataManager::requeue(const string& username, const vector<UserProgressLog::Record>& records) {
+    // 放回缓冲区头部等待下次重试，保持序列号递增的写入顺序；失败的追加可能已写入一部分，
+    // 重试时这部分会再写一次，重放跳过不大于已读最大序列号的记录，不会重复计数
+    size_t bytes = 0;
+    for (const auto& record : records) {
+        bytes += record_bytes(record);
+    }
+    
+    DirtyShard& shard = dirty_shard_of(username);
+    lock_guard<mutex> lock(shard.shard_mutex);
+    vector<UserProgressLog::Record>& pending = shard.records[username];
+    pending.insert(pending.begin(), records.begin(), records.end());
+    shard.bytes += bytes;
+    dirty_bytes += bytes;
+}
+
+UserDataManager::DirtyShard& UserDataManager::dirty_shard_of(const string& username) {
+    return dirty_shards[user_locks.shard_of(username)];
+}
+
+void UserDataManager::take_dirty(const string& username, vector<UserProgressLog::Record>& records) {
+    DirtyShard& shard = dirty_shard_of(username);
+    lock_guard<mutex> lock(shard.shard_mutex);
+    auto pending = shard.records.find(username);
+    if (pending == shard.records.end()) {
+        return;
+    }
+    records.swap(pending->second);
+    shard.records.erase(pending);
+    
+    size_t bytes = 0;
+    for (const auto& record : records) {
+        bytes += record_bytes(record);
+    }
+    shard.bytes -= bytes;
+    dirty_bytes -= bytes;
+}
+
+size_t UserDataManager::record_bytes(const UserProgressLog::Record& record) const {
+    // 序列号、操作、数值与时间戳约占32字节，再加上单词本身
+    size_t bytes = 32;
+    if (record.word_id != VocabularyCatalog::NOT_FOUND) {
+        bytes += catalog.word(record.word_id).size();
     }
+    return bytes;
+}
+
+bool UserDataManager::load_user_data(UserContext& context) {
+    const string& username = context.username;
+    
+    // 先把该用户缓冲中的记录写入日志，重新加载刚卸载的用户时才不会丢失
+    flush_user(username);
     
-    string user_file = get_user_data_file(current_user);
-    ofstream file(user_file);
-    if (!file.is_open()) {
-        cerr << "Error: Cannot save user data file for " << current_user << endl;
+    // 读快照与重放日志之间不能被压缩打断
+    lock_guard<mutex> snapshot_lock(UserProgressLog::snapshot_mutex(username));
+    if (!progress_file->load(username, context.progress)) {
         return false;
     }
     
+    // 在快照之上重放进度日志
+    context.log_seq = progress_log.replay(username, context.progress.log_seq,
+                                          [&context](const UserProgressLog::Record& record) {
+                                              context.progress.apply(record);
+                                          });
+    
+    // 日志过长时尽快压缩，保证下次加载的重放时间有界
+    if (progress_log.size(username) >= compactor->get_max_log_bytes()) {
+        compactor->request(username);
+    }
+    return true;
+}
+
+bool UserDataManager::save_user_data(UserContext& context) {
+    lock_guard<mutex> snapshot_lock(UserProgressLog::snapshot_mutex(context.username));
+    publish(context, true);
+    
     try {
-        file << user_data.dump(4);
-        file.close();
-        return true;
+        context.progress.log_seq = context.log_seq;
+        if (!progress_file->save(context.username, context.progress)) {
+            cerr << "Error: Cannot save user data file for " << context.username << endl;
+            return false;
+        }
     } catch (const exception& e) {
         cerr << "Error saving user data: " << e.what() << endl;
         return false;
     }
+    
+    // 快照已包含全部日志记录，缓冲中尚未落盘的记录也不再需要
+    vector<UserProgressLog::Record> merged;
+    take_dirty(context.username, merged);
+    progress_log.truncate(context.username);
+    return true;
 }
 
-bool UserDataManager::set_current_user(const string& username) {
-    if (username.empty()) {
-        current_user = "";
-        user_data = json::object();
+bool UserDataManager::append_log(UserContext& context, vector<UserProgressLog::Record>& records) {
+    if (records.empty()) {
         return true;
     }
     
-    if (load_user_data(username)) {
-        current_user = username;
-        return true;
+    // 估算字节数在分片锁外完成，锁内只做入队
+    size_t bytes = 0;
+    bool words_changed = false;
+    for (auto& record : records) {
+        record.seq = ++context.log_seq;
+        bytes += record_bytes(record);
+        words_changed = words_changed || record.word_id != VocabularyCatalog::NOT_FOUND;
+    }
+    
+    bool wake = false;
+    {
+        // 总字节数在分片锁内与分片字节数一起更新，落盘减去分片字节数时不会减成负数
+        DirtyShard& shard = dirty_shard_of(context.username);
+        lock_guard<mutex> lock(shard.shard_mutex);
+        vector<UserProgressLog::Record>& pending = shard.records[context.username];
+        pending.insert(pending.end(), records.begin(), records.end());
+        shard.bytes += bytes;
+        wake = (dirty_bytes += bytes) >= flush_bytes;
+    }
+    
+    // 一批记录只发布一个新版本
+    publish(context, words_changed);
+    if (wake) {
+        flush_wakeup.notify_one();
     }
-    return false;
+    return true;
 }
 
-string UserDataManager::get_current_user() const {
-    return current_user;
+void UserDataManager::publish(UserContext& context, bool words_changed) {
+    // 写者由用户独占锁串行化，这里读到的就是最新版本
+    const ProgressSnapshot* previous = context.snapshot.load(memory_order_relaxed);
+    
+    auto next = make_unique<ProgressSnapshot>();
+    next->version = previous ? previous->version + 1 : 1;
+    next->totals = context.progress.get_totals();
+    next->learn_position = learn_position(context);
+    next->review_position = review_position(context);
+    if (previous && !words_changed) {
+        next->set_review_words(previous->get_review_words());
+    }
+    context.memory_bytes.store(context.progress.memory_usage() + next->memory_usage(), memory_order_relaxed);
+    
+    context.snapshot.exchange(next.release());
+    if (previous) {
+        EpochReclaimer::instance().retire(previous);
+    }
 }
 
-json UserDataManager::get_learn_words(int page, int words_per_page) {
-    if (current_user.empty() || !user_data.contains("words")) {
-        return {
-            {"success", false},
-            {"error", "No user data loaded"}
-        };
+shared_ptr<UserContext> UserDataManager::acquire(const string& username) {
+    CacheShard& shard = cache_shard_of(username);
+    vector<string> evicted;
+    unique_lock<mutex> lock = lock_cache(shard);
+    auto it = shard.contexts.find(username);
+    if (it != shard.contexts.end()) {
+        // 命中：移到链表头部，并按修改后记录的大小重新计算占用
+        CacheEntry& entry = it->second;
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru_position);
+        shard.bytes -= entry.bytes;
+        entry.bytes = entry.context->memory_bytes.load(memory_order_relaxed);
+        shard.bytes += entry.bytes;
+        shard.hits++;
+        shared_ptr<UserContext> context = entry.context;
+        evict_cold_users(shard, username, evicted);
+        if (lock.owns_lock()) {
+            lock.unlock();
+        }
+        for (const string& name : evicted) {
+            flush_user(name);
+        }
+        return context;
+    }
+    
+    // 其他请求正在加载同一用户：等它的结果，不重复加载
+    auto pending = shard.loading.find(username);
+    if (pending != shard.loading.end()) {
+        shared_future<shared_ptr<UserContext>> loaded = pending->second;
+        if (lock.owns_lock()) {
+            lock.unlock();
+        }
+        return loaded.get();
+    }
+    
+    shard.misses++;
+    promise<shared_ptr<UserContext>> loaded;
+    shard.loading.emplace(username, loaded.get_future().share());
+    if (lock.owns_lock()) {
+        lock.unlock();
+    }
+    
+    // 读快照与重放日志不持有分片锁，同分片其他用户的命中不被阻塞
+    auto context = make_shared<UserContext>(username, catalog);
+    try {
+        if (load_user_data(*context)) {
+            publish(*context, true);
+        } else {
+            context = nullptr;
+        }
+    } catch (const exception& e) {
+        // 占位必须撤下，否则等待同一用户的请求永远阻塞
+        cerr << "Error loading user data: " << e.what() << endl;
+        context = nullptr;
+    }
+    
+    if (!actor_mode) {
+        lock.lock();
+    }
+    shard.loading.erase(username);
+    if (context) {
+        shard.lru.push_front(username);
+        CacheEntry& entry = shard.contexts[username];
+        entry.context = context;
+        entry.lru_position = shard.lru.begin();
+        entry.bytes = context->memory_bytes;
+        shard.bytes += entry.bytes;
+        shard.users++;
+        evict_cold_users(shard, username, evicted);
+    }
+    if (lock.owns_lock()) {
+        lock.unlock();
+    }
+    
+    loaded.set_value(context);
+    for (const string& name : evicted) {
+        flush_user(name);
     }
+    return context;
+}
+
+void UserDataManager::evict_cold_users(CacheShard& shard, const string& keep, vector<string>& evicted) {
+    size_t shard_budget = cache_budget / cache_shard_count;
+    auto position = shard.lru.end();
+    while (shard.bytes > shard_budget && position != shard.lru.begin()) {
+        --position;
+        auto it = shard.contexts.find(*position);
+        // 正在被请求使用的上下文不能淘汰，否则同一用户会同时存在两份状态
+        if (*position == keep || it->second.context.use_count() > 1) {
+            continue;
+        }
+        
+        // 缓冲记录稍后落盘；在此之前重新加载该用户时 load_user_data 会先落盘
+        evicted.push_back(*position);
+        shard.bytes -= it->second.bytes;
+        shard.users--;
+        shard.evictions++;
+        shard.contexts.erase(it);
+        position = shard.lru.erase(position);
+    }
+}
+
+void UserDataManager::evict(const string& username) {
+    CacheShard& shard = cache_shard_of(username);
+    {
+        unique_lock<mutex> lock = lock_cache(shard);
+        auto it = shard.contexts.find(username);
+        if (it != shard.contexts.end()) {
+            shard.bytes -= it->second.bytes;
+            shard.users--;
+            shard.lru.erase(it->second.lru_position);
+            shard.contexts.erase(it);
+        }
+    }
+    
+    // 等正在进行的落盘写完，再丢弃缓冲中的记录
+    {
+        lock_guard<mutex> flush_lock(flush_mutex);
+        vector<UserProgressLog::Record> discarded;
+        take_dirty(username, discarded);
+    }
+    compactor->cancel(username);
+}
+
+bool UserDataManager::read_resident(const string& username, ProgressTotals& totals, json& user_info) {
+    shared_ptr<UserContext> context;
+    {
+        CacheShard& shard = cache_shard_of(username);
+        unique_lock<mutex> lock = lock_cache(shard);
+        auto it = shard.contexts.find(username);
+        if (it == shard.contexts.end()) {
+            return false;
+        }
+        context = it->second.context;
+    }
+    
+    auto lock = user_locks.lock_shared(username);
+    totals = context->progress.get_totals();
+    user_info = context->progress.user_info;
+    return true;
+}
+
+UserDataManager::CacheShard& UserDataManager::cache_shard_of(const string& username) {
+    return cache_shards[hash<string>()(username) % cache_shard_count];
+}
+
+unique_lock<mutex> UserDataManager::lock_cache(CacheShard& shard) {
+    if (actor_mode) {
+        return unique_lock<mutex>(shard.shard_mutex, defer_lock);
+    }
+    return unique_lock<mutex>(shard.shard_mutex);
+}
+
+json UserDataManager::get_cache_stats() {
+    size_t resident_users = 0;
+    size_t resident_bytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    for (size_t i = 0; i < cache_shard_count; i++) {
+        // 只读原子计数，actor 模式下也不需要进入分片线程
+        const CacheShard& shard = cache_shards[i];
+        resident_users += shard.users.load(memory_order_relaxed);
+        resident_bytes += shard.bytes.load(memory_order_relaxed);
+        hits += shard.hits.load(memory_order_relaxed);
+        misses += shard.misses.load(memory_order_relaxed);
+        evictions += shard.evictions.load(memory_order_relaxed);
+    }
+    
+    uint64_t lookups = hits + misses;
+    return {
+        {"success", true},
+        {"cache", {
+            {"shards", cache_shard_count},
+            {"resident_users", resident_users},
+            {"resident_bytes", resident_bytes},
+            {"budget_bytes", cache_budget},
+            {"hits", hits},
+            {"misses", misses},
+            {"evictions", evictions},
+            {"hit_rate", lookups > 0 ? (double)hits / lookups : 0.0}
+        }}
+    };
+}
+
+void UserDataManager::disable_user_locks(size_t shard_count) {
+    user_locks.disable();
+    
+    // 缓存分片与执行器分片一一对应，每片只被一个线程访问
+    cache_shard_count = max<size_t>(1, shard_count);
+    cache_shards.reset(new CacheShard[cache_shard_count]);
+    actor_mode = true;
+}
+
+json UserDataManager::get_lock_stats() const {
+    return {
+        {"success", true},
+        {"locks", user_locks.get_stats()}
+    };
+}
+
+bool UserDataManager::record_login(UserContext& context) {
+    auto lock = user_locks.lock_exclusive(context.username);
     
-    vector<string> all_words;
-    for (auto& [word, word_data] : user_data["words"].items()) {
-        all_words.push_back(word);
+    // 登录信息通过常驻的上下文保存，避免与该用户其他会话的保存互相覆盖
+    context.progress.user_info["last_login"] = time(nullptr);
+    context.progress.user_info["total_sessions"] = context.progress.user_info.value("total_sessions", 0) + 1;
+    return save_user_data(context);
+}
+
+json UserDataManager::get_learn_words(UserContext& context, int page, int words_per_page) {
+    // 学习顺序由共享词表预先算好，分页只是取其中一段
+    const vector<uint32_t>& all_words = catalog.learn_order();
+    
+    int last_position;
+    {
+        EpochReclaimer::Guard guard(EpochReclaimer::instance());
+        last_position = context.snapshot.load()->learn_position;
     }
-    sort(all_words.begin(), all_words.end());
     
     // 如果page为0，从上次学习位置开始
     if (page == 0) {
-        int last_position = get_learn_position();
         page = (last_position / words_per_page) + 1;
     }
     
@@ -110,19 +502,23 @@ json UserDataManager::get_learn_words(int page, int words_per_page) {
             {"words", json::array()},
             {"totalPages", (all_words.size() + words_per_page - 1) / words_per_page},
             {"currentPage", page},
-            {"username", current_user},
+            {"username", context.username},
             {"completed", true},
             {"message", "Congratulations! You have completed all words."}
         };
     }
     
-    vector<string> paginated_words;
+    json paginated_words = json::array();
+    paginated_words.get_ref<json::array_t&>().reserve(end_index - start_index);
     for (int i = start_index; i < end_index; i++) {
-        paginated_words.push_back(all_words[i]);
+        paginated_words.push_back(catalog.word(all_words[i]));
     }
     
-    // 更新学习位置
-    update_learn_position(start_index);
+    // 更新学习位置（重复请求同一页时不加锁）
+    if (start_index != last_position) {
+        auto lock = user_locks.lock_exclusive(context.username);
+        set_learn_position(context, start_index);
+    }
     
     int total_pages = (all_words.size() + words_per_page - 1) / words_per_page;
     
@@ -131,7 +527,7 @@ json UserDataManager::get_learn_words(int page, int words_per_page) {
         {"words", paginated_words},
         {"totalPages", total_pages},
         {"currentPage", page},
-        {"username", current_user},
+        {"username", context.username},
         {"progress", {
             {"current_position", start_index},
             {"total_words", all_words.size()},
@@ -141,17 +537,7 @@ json UserDataManager::get_learn_words(int page, int words_per_page) {
 }
 
 json UserDataManager::get_exam_words(int count) {
-    if (current_user.empty() || !user_data.contains("words")) {
-        return {
-            {"success", false},
-            {"error", "No user data loaded"}
-        };
-    }
-    
-    vector<string> all_words;
-    for (auto& [word, word_data] : user_data["words"].items()) {
-        all_words.push_back(word);
-    }
+    vector<string> all_words = catalog.words();
     
     if (all_words.size() <= count) {
         return {
@@ -171,191 +557,196 @@ json UserDataManager::get_exam_words(int count) {
     };
 }
 
-bool UserDataManager::update_mistakes_batch(const vector<string>& words_to_update) {
-    if (current_user.empty()) return false;
-    
-    // 重新加载数据以确保最新状态
-    load_user_data(current_user);
+bool UserDataManager::update_mistakes_batch(UserContext& context, const vector<string>& words_to_update) {
+    auto lock = user_locks.lock_exclusive(context.username);
     
+    long now = time(nullptr);
+    vector<UserProgressLog::Record> records;
     for (const string& word : words_to_update) {
-        if (user_data["words"].contains(word)) {
-            user_data["words"][word]["mistakes"] = user_data["words"][word]["mistakes"].get<int>() + 1;
-            user_data["words"][word]["last_seen"] = time(nullptr);
+        uint32_t id = catalog.id_of(word);
+        if (id != VocabularyCatalog::NOT_FOUND) {
+            UserProgressLog::Record record;
+            record.op = UserProgressLog::OP_MISTAKE;
+            record.word_id = id;
+            record.value = 1;
+            record.timestamp = now;
+            context.progress.apply(record);
+            records.push_back(record);
         }
     }
     
-    return save_user_data();
+    // 只记入写回缓冲，由后台线程批量追加到日志
+    return append_log(context, records);
 }
 
-bool UserDataManager::update_correct_batch(const vector<string>& words_correct) {
-    if (current_user.empty()) return false;
-    
-    // 重新加载数据以确保最新状态
-    load_user_data(current_user);
+bool UserDataManager::update_correct_batch(UserContext& context, const vector<string>& words_correct) {
+    auto lock = user_locks.lock_exclusive(context.username);
     
+    long now = time(nullptr);
+    vector<UserProgressLog::Record> records;
     for (const string& word : words_correct) {
-        if (user_data["words"].contains(word)) {
-            user_data["words"][word]["correct_count"] = user_data["words"][word]["correct_count"].get<int>() + 1;
-            user_data["words"][word]["last_seen"] = time(nullptr);
+        uint32_t id = catalog.id_of(word);
+        if (id != VocabularyCatalog::NOT_FOUND) {
+            UserProgressLog::Record record;
+            record.op = UserProgressLog::OP_CORRECT;
+            record.word_id = id;
+            record.value = 1;
+            record.timestamp = now;
+            context.progress.apply(record);
+            records.push_back(record);
         }
     }
     
-    return save_user_data();
+    // 只记入写回缓冲，由后台线程批量追加到日志
+    return append_log(context, records);
 }
 
-json UserDataManager::get_review_words(int page, int words_per_page) {
-    if (current_user.empty() || !user_data.contains("words")) {
-        return {
-            {"success", false},
-            {"error", "No user data loaded"}
-        };
-    }
-    
-    vector<json> all_review_words;
-    for (auto& [word, word_data] : user_data["words"].items()) {
-        int mistakes = word_data["mistakes"].get<int>();
-        if (mistakes > 0) {
-            all_review_words.push_back({
-                {"word", word},
-                {"mistakes", mistakes},
-                {"correct_count", word_data.value("correct_count", 0)},
-                {"last_seen", word_data.value("last_seen", 0)}
-            });
-        }
-    }
-    
-    // 按错误次数降序排序，错误次数相同则按最后见到时间升序
-    sort(all_review_words.begin(), all_review_words.end(), 
-         [](const json& a, const json& b) {
-             int mistakes_a = a["mistakes"].get<int>();
-             int mistakes_b = b["mistakes"].get<int>();
-             if (mistakes_a != mistakes_b) {
-                 return mistakes_a > mistakes_b;
-             }
-             return a["last_seen"].get<long>() < b["last_seen"].get<long>();
-         });
-
-
+json UserDataManager::review_entry_json(const ReviewEntry& entry) const {
+    return {
+        {"word", catalog.word(entry.id)},
+        {"mistakes", entry.mistakes},
+        {"correct_count", entry.correct_count},
+        {"last_seen", entry.last_seen}
+    };
+}
 
-    // 如果page为0或1，从上次复习位置开始（但复习位置要合理）
-    if (page == 0 || (page == 1 && get_review_position() > 0)) {
-        int last_position = get_review_position();
-        // 如果上次位置超出范围，重置为0
-        if (last_position >= (int)all_review_words.size()) {
-            last_position = 0;
-            update_review_position(0);
+json UserDataManager::get_review_words(UserContext& context, int page, int words_per_page) {
+    size_t total_review;
+    int last_position;
+    int position;
+    int start_index;
+    int end_index;
+    json paginated_review_words = json::array();
+    {
+        // 共享锁内按名次从有序索引取出一页：O(log n + 页大小)，不随复习单词总数增长
+        auto lock = user_locks.lock_shared(context.username);
+        const ReviewIndex& review_index = context.progress.get_review_index();
+        total_review = review_index.size();
+        last_position = review_position(context);
+        position = last_position;
+        
+        // 如果page为0或1，从上次复习位置开始（但复习位置要合理）
+        if (page == 0 || (page == 1 && position > 0)) {
+            // 如果上次位置超出范围，重置为0
+            if (position >= (int)total_review) {
+                position = 0;
+            }
+            page = (position / words_per_page) + 1;
+        }
+        
+        start_index = (page - 1) * words_per_page;
+        end_index = min(start_index + words_per_page, (int)total_review);
+        if (start_index < (int)total_review) {
+            paginated_review_words.get_ref<json::array_t&>().reserve(end_index - start_index);
+            for (uint32_t id : review_index.range(start_index, end_index - start_index)) {
+                WordProgress word = context.progress.get(id);
+                paginated_review_words.push_back(review_entry_json({id, word.mistakes, word.correct_count, word.last_seen}));
+            }
         }
-        page = (last_position / words_per_page) + 1;
     }
     
-    int start_index = (page - 1) * words_per_page;
-    int end_index = min(start_index + words_per_page, (int)all_review_words.size());
+    // 更新复习位置
+    // 如果这是最后一页，重置复习位置为0，这样下次复习可以从头开始
+    if (start_index < (int)total_review) {
+        position = end_index >= (int)total_review ? 0 : start_index;
+    }
+    // 重复请求同一页时位置不变，不加独占锁也不写日志
+    if (position != last_position) {
+        auto lock = user_locks.lock_exclusive(context.username);
+        set_review_position(context, position);
+    }
     
-    if (start_index >= (int)all_review_words.size()) {
+    if (start_index >= (int)total_review) {
         // 已经复习完所有错误单词
         return {
             {"success", true},
             {"review_words", json::array()},
-            {"totalPages", (all_review_words.size() + words_per_page - 1) / words_per_page},
+            {"totalPages", (total_review + words_per_page - 1) / words_per_page},
             {"currentPage", page},
-            {"username", current_user},
+            {"username", context.username},
             {"completed", true},
             {"message", "Congratulations! You have reviewed all mistake words."}
         };
     }
     
-    vector<json> paginated_review_words;
-    for (int i = start_index; i < end_index; i++) {
-        paginated_review_words.push_back(all_review_words[i]);
-    }
-    
-    // 更新复习位置
-    // 如果这是最后一页，重置复习位置为0，这样下次复习可以从头开始
-    if (end_index >= (int)all_review_words.size()) {
-        update_review_position(0);
-    } else {
-        update_review_position(start_index);
-    }
-    
-    int total_pages = (all_review_words.size() + words_per_page - 1) / words_per_page;
+    int total_pages = (total_review + words_per_page - 1) / words_per_page;
     
     return {
         {"success", true},
         {"review_words", paginated_review_words},
         {"totalPages", total_pages},
         {"currentPage", page},
-        {"username", current_user},
-        {"total_review", all_review_words.size()},
+        {"username", context.username},
+        {"total_review", total_review},
         {"progress", {
             {"current_position", start_index},
-            {"total_review_words", all_review_words.size()},
-            {"completion_percentage", all_review_words.size() > 0 ? (double)start_index / all_review_words.size() * 100 : 0}
+            {"total_review_words", total_review},
+            {"completion_percentage", total_review > 0 ? (double)start_index / total_review * 100 : 0}
         }}
     };
 }
 
-json UserDataManager::get_all_review_words() {
-    if (current_user.empty() || !user_data.contains("words")) {
-        return {
-            {"success", false},
-            {"error", "No user data loaded"}
-        };
-    }
+shared_ptr<const vector<ReviewEntry>> UserDataManager::snapshot_review_words(UserContext& context,
+                                                                            const ProgressSnapshot*& snapshot) {
+    snapshot = context.snapshot.load();
+    shared_ptr<const vector<ReviewEntry>> words = snapshot->get_review_words();
+    if (words) {
+        return words;
+    }
+    
+    // 共享锁内没有写者，此时的最新版本与进度一致
+    auto lock = user_locks.lock_shared(context.username);
+    snapshot = context.snapshot.load();
+    words = snapshot->get_review_words();
+    if (words) {
+        return words;
+    }
+    
+    auto built = make_shared<vector<ReviewEntry>>();
+    const ReviewIndex& review_index = context.progress.get_review_index();
+    built->reserve(review_index.size());
+    review_index.for_each([&context, &built](uint32_t id) {
+        WordProgress word = context.progress.get(id);
+        built->push_back({id, word.mistakes, word.correct_count, word.last_seen});
+    });
+    words = snapshot->set_review_words(built);
+    if (words == built) {
+        context.memory_bytes.fetch_add(built->capacity() * sizeof(ReviewEntry), memory_order_relaxed);
+    }
+    return words;
+}
+
+json UserDataManager::get_all_review_words(UserContext& context) {
+    EpochReclaimer::Guard guard(EpochReclaimer::instance());
+    const ProgressSnapshot* snapshot;
+    shared_ptr<const vector<ReviewEntry>> words = snapshot_review_words(context, snapshot);
     
-    vector<json> all_review_words;
-    for (auto& [word, word_data] : user_data["words"].items()) {
-        int mistakes = word_data["mistakes"].get<int>();
-        if (mistakes > 0) {
-            all_review_words.push_back({
-                {"word", word},
-                {"mistakes", mistakes},
-                {"correct_count", word_data.value("correct_count", 0)},
-                {"last_seen", word_data.value("last_seen", 0)}
-            });
-        }
+    // 快照中已按索引顺序排好
+    json review_words = json::array();
+    review_words.get_ref<json::array_t&>().reserve(words->size());
+    for (const ReviewEntry& entry : *words) {
+        review_words.push_back(review_entry_json(entry));
     }
     
-    // 按错误次数降序排序，错误次数相同则按最后见到时间升序
-    sort(all_review_words.begin(), all_review_words.end(), 
-         [](const json& a, const json& b) {
-             int mistakes_a = a["mistakes"].get<int>();
-             int mistakes_b = b["mistakes"].get<int>();
-             if (mistakes_a != mistakes_b) {
-                 return mistakes_a > mistakes_b;
-             }
-             return a["last_seen"].get<long>() < b["last_seen"].get<long>();
-         });
-    
     return {
         {"success", true},
-        {"review_words", all_review_words},
-        {"total_review", all_review_words.size()}
+        {"review_words", review_words},
+        {"total_review", words->size()}
     };
 }
 
-json UserDataManager::get_stats() {
-    if (current_user.empty() || !user_data.contains("words")) {
-        return {
-            {"success", false},
-            {"error", "No user data loaded"}
-        };
-    }
+json UserDataManager::get_stats(UserContext& context) {
+    // 读取最新发布的只读版本，不会被正在执行的批量更新阻塞
+    EpochReclaimer::Guard guard(EpochReclaimer::instance());
+    const ProgressSnapshot& snapshot = *context.snapshot.load();
     
-    int total_words = user_data["words"].size();
-    int review_count = 0;
-    int total_mistakes = 0;
-    int total_correct = 0;
+    int total_words = catalog.size();
     
-    for (auto& [word, word_data] : user_data["words"].items()) {
-        int mistakes = word_data["mistakes"].get<int>();
-        int correct = word_data.value("correct_count", 0);
-        
-        if (mistakes > 0) {
-            review_count++;
-        }
-        total_mistakes += mistakes;
-        total_correct += correct;
-    }
+    // 计数随每次修改增量维护，无需扫描
+    const ProgressTotals& totals = snapshot.totals;
+    int review_count = totals.review_count;
+    int total_mistakes = totals.total_mistakes;
+    int total_correct = totals.total_correct;
     
     int known_count = total_words - review_count;
     double accuracy = (total_mistakes + total_correct) > 0 ? 
@@ -370,69 +761,113 @@ json UserDataManager::get_stats() {
             {"total_mistakes", total_mistakes},
             {"total_correct", total_correct},
             {"accuracy", accuracy},
-            {"current_position", get_learn_position()},
-            {"completion_percentage", total_words > 0 ? (double)get_learn_position() / total_words * 100 : 0}
+            {"current_position", snapshot.learn_position},
+            {"completion_percentage", total_words > 0 ? (double)snapshot.learn_position / total_words * 100 : 0}
         }},
-        {"username", current_user}
+        {"username", context.username}
     };
 }
 
-bool UserDataManager::update_learn_position(int position) {
-    if (current_user.empty()) return false;
+json UserDataManager::recount_stats(UserContext& context) {
+    auto lock = user_locks.lock_exclusive(context.username);
+    
+    ProgressTotals counted = context.progress.get_totals();
+    ProgressTotals actual = context.progress.recount();
+    bool drift = !(counted == actual);
+    if (drift) {
+        cerr << "Warning: Stats counters drifted for " << context.username << ", rebuilding" << endl;
+        context.progress.rebuild_totals();
+        publish(context, false);
+    }
+    
+    auto totals_json = [](const ProgressTotals& totals) {
+        return json{
+            {"review", totals.review_count},
+            {"total_mistakes", totals.total_mistakes},
+            {"total_correct", totals.total_correct}
+        };
+    };
     
-    user_data["user_info"]["last_learn_position"] = position;
-    return save_user_data();
+    return {
+        {"success", true},
+        {"username", context.username},
+        {"drift", drift},
+        {"counters", totals_json(counted)},
+        {"recount", totals_json(actual)}
+    };
+}
+
+bool UserDataManager::update_learn_position(UserContext& context, int position) {
+    auto lock = user_locks.lock_exclusive(context.username);
+    return set_learn_position(context, position);
 }
 
-int UserDataManager::get_learn_position() {
-    if (current_user.empty() || !user_data.contains("user_info")) {
-        return 0;
+int UserDataManager::get_learn_position(const UserContext& context) {
+    EpochReclaimer::Guard guard(EpochReclaimer::instance());
+    return context.snapshot.load()->learn_position;
+}
+
+bool UserDataManager::update_review_position(UserContext& context, int position) {
+    auto lock = user_locks.lock_exclusive(context.username);
+    return set_review_position(context, position);
+}
+
+int UserDataManager::get_review_position(const UserContext& context) {
+    EpochReclaimer::Guard guard(EpochReclaimer::instance());
+    return context.snapshot.load()->review_position;
+}
+
+int UserDataManager::learn_position(const UserContext& context) {
+    return context.progress.user_info.value("last_learn_position", 0);
+}
+
+bool UserDataManager::set_learn_position(UserContext& context, int position) {
+    // 位置未变化（例如重复请求同一页）时不写日志
+    if (context.progress.user_info.value("last_learn_position", -1) == position) {
+        return true;
     }
     
-    return user_data["user_info"].value("last_learn_position", 0);
+    vector<UserProgressLog::Record> records(1);
+    records[0].op = UserProgressLog::OP_LEARN_POSITION;
+    records[0].value = position;
+    records[0].timestamp = time(nullptr);
+    context.progress.apply(records[0]);
+    return append_log(context, records);
 }
 
-bool UserDataManager::update_review_position(int position) {
-    if (current_user.empty()) return false;
-    
-    user_data["user_info"]["last_review_position"] = position;
-    return save_user_data();
+int UserDataManager::review_position(const UserContext& context) {
+    return context.progress.user_info.value("last_review_position", 0);
 }
 
-int UserDataManager::get_review_position() {
-    if (current_user.empty() || !user_data.contains("user_info")) {
-        return 0;
+bool UserDataManager::set_review_position(UserContext& context, int position) {
+    // 位置未变化（例如并发请求已写入同一位置）时不写日志
+    if (context.progress.user_info.value("last_review_position", -1) == position) {
+        return true;
     }
     
-    return user_data["user_info"].value("last_review_position", 0);
+    vector<UserProgressLog::Record> records(1);
+    records[0].op = UserProgressLog::OP_REVIEW_POSITION;
+    records[0].value = position;
+    records[0].timestamp = time(nullptr);
+    context.progress.apply(records[0]);
+    return append_log(context, records);
 }
 
-json UserDataManager::reset_progress(bool reset_mistakes, bool reset_position) {
-    if (current_user.empty()) {
-        return {
-            {"success", false},
-            {"error", "No user logged in"}
-        };
-    }
+json UserDataManager::reset_progress(UserContext& context, bool reset_mistakes, bool reset_position) {
+    auto lock = user_locks.lock_exclusive(context.username);
     
     int reset_count = 0;
     
     if (reset_mistakes) {
-        for (auto& [word, word_data] : user_data["words"].items()) {
-            if (word_data["mistakes"].get<int>() > 0) {
-                reset_count++;
-            }
-            word_data["mistakes"] = 0;
-            word_data["correct_count"] = 0;
-            word_data["last_seen"] = 0;
-        }
+        reset_count = context.progress.get_totals().review_count;
+        context.progress.clear_words();
     }
     
     if (reset_position) {
-        user_data["user_info"]["last_learn_position"] = 0;
+        context.progress.user_info["last_learn_position"] = 0;
     }
     
-    if (save_user_data()) {
+    if (save_user_data(context)) {
         return {
             {"success", true},
             {"message", "Progress reset successfully"},
@@ -448,35 +883,30 @@ json UserDataManager::reset_progress(bool reset_mistakes, bool reset_position) {
     }
 }
 
-json UserDataManager::get_learning_history(int limit) {
-    if (current_user.empty()) {
-        return {
-            {"success", false},
-            {"error", "No user logged in"}
-        };
-    }
+json UserDataManager::get_learning_history(UserContext& context, int limit) {
+    auto lock = user_locks.lock_shared(context.username);
     
     // 这里可以扩展为真正的历史记录功能
     // 目前返回基本的用户信息
     return {
         {"success", true},
         {"history", {
-            {"user_info", user_data["user_info"]},
+            {"user_info", context.progress.user_info},
             {"recent_activity", "Learning history feature coming soon"}
         }}
     };
 }
 
-bool UserDataManager::record_learning_session(const string& session_type, int words_count, 
+bool UserDataManager::record_learning_session(UserContext& context, const string& session_type, int words_count, 
                                              int correct_count, int duration) {
-    if (current_user.empty()) return false;
+    auto lock = user_locks.lock_exclusive(context.username);
     
     // 更新总学习时间
-    int total_time = user_data["user_info"].value("total_learning_time", 0);
-    user_data["user_info"]["total_learning_time"] = total_time + duration;
+    int total_time = context.progress.user_info.value("total_learning_time", 0);
+    context.progress.user_info["total_learning_time"] = total_time + duration;
     
     // 更新最后活动时间
-    user_data["user_info"]["last_activity"] = time(nullptr);
+    context.progress.user_info["last_activity"] = time(nullptr);
     
-    return save_user_data();
+    return save_user_data(context);
 }
@@ -0,0 +1,78 @@
+#include "UserLockTable.h"
+#include <functional>
+
+UserLockTable::UserLockTable(size_t shard_count)
+    : count(shard_count > 0 ? shard_count : 1), shards(new Shard[count]) {}
+
+size_t UserLockTable::shard_of(const string& username) const {
+    return hash<string>()(username) % count;
+}
+
+size_t UserLockTable::shard_count() const {
+    return count;
+}
+
+void UserLockTable::disable() {
+    enabled = false;
+}
+
+shared_lock<shared_mutex> UserLockTable::lock_shared(const string& username) {
+    if (!enabled) {
+        return shared_lock<shared_mutex>();
+    }
+    Shard& shard = shards[shard_of(username)];
+    shared_lock<shared_mutex> lock(shard.mutex, try_to_lock);
+    if (!lock.owns_lock()) {
+        // 先尝试不等待地加锁，失败才算一次争用
+        shard.contended.fetch_add(1, memory_order_relaxed);
+        lock.lock();
+    }
+    shard.shared_acquisitions.fetch_add(1, memory_order_relaxed);
+    return lock;
+}
+
+unique_lock<shared_mutex> UserLockTable::lock_exclusive(const string& username) {
+    if (!enabled) {
+        return unique_lock<shared_mutex>();
+    }
+    Shard& shard = shards[shard_of(username)];
+    unique_lock<shared_mutex> lock(shard.mutex, try_to_lock);
+    if (!lock.owns_lock()) {
+        shard.contended.fetch_add(1, memory_order_relaxed);
+        lock.lock();
+    }
+    shard.exclusive_acquisitions.fetch_add(1, memory_order_relaxed);
+    return lock;
+}
+
+json UserLockTable::get_stats() const {
+    json shard_stats = json::array();
+    uint64_t total_shared = 0;
+    uint64_t total_exclusive = 0;
+    uint64_t total_contended = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t shared = shards[i].shared_acquisitions.load(memory_order_relaxed);
+        uint64_t exclusive = shards[i].exclusive_acquisitions.load(memory_order_relaxed);
+        uint64_t contended = shards[i].contended.load(memory_order_relaxed);
+        total_shared += shared;
+        total_exclusive += exclusive;
+        total_contended += contended;
+        if (shared + exclusive == 0) {
+            continue;
+        }
+        shard_stats.push_back({
+            {"shard", i},
+            {"shared", shared},
+            {"exclusive", exclusive},
+            {"contended", contended}
+        });
+    }
+    return {
+        {"enabled", enabled},
+        {"shard_count", count},
+        {"shared", total_shared},
+        {"exclusive", total_exclusive},
+        {"contended", total_contended},
+        {"shards", shard_stats}
+    };
+}
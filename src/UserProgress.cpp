@@ -0,0 +1,174 @@
+#include "UserProgress.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+template <typename T>
+T saturate(long long value) {
+    if (value < 0) return 0;
+    if ((unsigned long long)value > (unsigned long long)numeric_limits<T>::max()) {
+        return numeric_limits<T>::max();
+    }
+    return (T)value;
+}
+
+}
+
+UserProgress::UserProgress(const VocabularyCatalog& catalog)
+    : mistake_counts(catalog.size(), 0), correct_counts(catalog.size(), 0), last_seen_times(catalog.size(), 0),
+      review_index(&catalog.alphabetical_ranks()) {}
+
+size_t UserProgress::size() const {
+    return mistake_counts.size();
+}
+
+size_t UserProgress::memory_usage() const {
+    // user_info 只有少量字段，按固定 1KB 计算，避免每次估算都序列化
+    return sizeof(UserProgress) + 1024 +
+           mistake_counts.capacity() * sizeof(uint16_t) +
+           correct_counts.capacity() * sizeof(uint16_t) +
+           last_seen_times.capacity() * sizeof(uint32_t) +
+           review_index.memory_usage() - sizeof(ReviewIndex);
+}
+
+WordProgress UserProgress::get(uint32_t id) const {
+    WordProgress progress;
+    if (id < size()) {
+        progress.mistakes = mistake_counts[id];
+        progress.correct_count = correct_counts[id];
+        progress.last_seen = last_seen_times[id];
+    }
+    return progress;
+}
+
+void UserProgress::update_word(uint32_t id, uint16_t mistakes, uint16_t correct, uint32_t last_seen) {
+    uint16_t old_mistakes = mistake_counts[id];
+    uint16_t old_correct = correct_counts[id];
+    totals.review_count += (mistakes > 0) - (old_mistakes > 0);
+    totals.total_mistakes += (int64_t)mistakes - old_mistakes;
+    totals.total_correct += (int64_t)correct - old_correct;
+
+    // 只有排序键变化时才需要调整索引
+    if (mistakes != old_mistakes || (mistakes > 0 && last_seen != last_seen_times[id])) {
+        review_index.update(id, mistakes, last_seen);
+    }
+
+    mistake_counts[id] = mistakes;
+    correct_counts[id] = correct;
+    last_seen_times[id] = last_seen;
+}
+
+void UserProgress::set(uint32_t id, const WordProgress& progress) {
+    if (id >= size()) {
+        return;
+    }
+    update_word(id, progress.mistakes, progress.correct_count, progress.last_seen);
+}
+
+void UserProgress::apply(const UserProgressLog::Record& record) {
+    switch (record.op) {
+        case UserProgressLog::OP_MISTAKE:
+            if (record.word_id < size()) {
+                update_word(record.word_id,
+                            saturate<uint16_t>((long long)mistake_counts[record.word_id] + record.value),
+                            correct_counts[record.word_id],
+                            saturate<uint32_t>(record.timestamp));
+            }
+            break;
+        case UserProgressLog::OP_CORRECT:
+            if (record.word_id < size()) {
+                update_word(record.word_id, mistake_counts[record.word_id],
+                            saturate<uint16_t>((long long)correct_counts[record.word_id] + record.value),
+                            saturate<uint32_t>(record.timestamp));
+            }
+            break;
+        case UserProgressLog::OP_LEARN_POSITION:
+            user_info["last_learn_position"] = record.value;
+            break;
+        case UserProgressLog::OP_REVIEW_POSITION:
+            user_info["last_review_position"] = record.value;
+            break;
+        default:
+            break;
+    }
+}
+
+void UserProgress::clear_words() {
+    fill(mistake_counts.begin(), mistake_counts.end(), 0);
+    fill(correct_counts.begin(), correct_counts.end(), 0);
+    fill(last_seen_times.begin(), last_seen_times.end(), 0);
+    totals = ProgressTotals();
+    review_index.clear();
+}
+
+const ProgressTotals& UserProgress::get_totals() const {
+    return totals;
+}
+
+const ReviewIndex& UserProgress::get_review_index() const {
+    return review_index;
+}
+
+ProgressTotals UserProgress::recount() const {
+    return ProgressKernels::aggregate(mistake_counts.data(), correct_counts.data(), size());
+}
+
+void UserProgress::rebuild_totals() {
+    totals = recount();
+}
+
+const uint16_t* UserProgress::mistakes() const {
+    return mistake_counts.data();
+}
+
+const uint16_t* UserProgress::correct() const {
+    return correct_counts.data();
+}
+
+const uint32_t* UserProgress::last_seen() const {
+    return last_seen_times.data();
+}
+
+json UserProgress::to_json(const VocabularyCatalog& catalog) const {
+    json user_data = json::object();
+    user_data["user_info"] = user_info;
+    user_data["user_info"]["log_seq"] = log_seq;
+
+    json word_data = json::object();
+    for (uint32_t id = 0; id < size() && id < catalog.size(); id++) {
+        WordProgress progress = get(id);
+        if (progress.is_default()) {
+            continue;
+        }
+        word_data[catalog.word(id)] = {
+            {"mistakes", progress.mistakes},
+            {"correct_count", progress.correct_count},
+            {"last_seen", progress.last_seen}
+        };
+    }
+    user_data["words"] = std::move(word_data);
+    return user_data;
+}
+
+UserProgress UserProgress::from_json(const json& user_data, const VocabularyCatalog& catalog) {
+    UserProgress progress(catalog);
+    progress.user_info = user_data.value("user_info", json::object());
+    progress.log_seq = progress.user_info.value("log_seq", (uint64_t)0);
+    progress.user_info.erase("log_seq");
+
+    if (user_data.contains("words") && user_data["words"].is_object()) {
+        for (auto& [word, word_data] : user_data["words"].items()) {
+            uint32_t id = catalog.id_of(word);
+            if (id == VocabularyCatalog::NOT_FOUND) {
+                continue;
+            }
+            WordProgress word_progress;
+            word_progress.mistakes = saturate<uint16_t>(word_data.value("mistakes", 0LL));
+            word_progress.correct_count = saturate<uint16_t>(word_data.value("correct_count", 0LL));
+            word_progress.last_seen = saturate<uint32_t>(word_data.value("last_seen", 0LL));
+            progress.set(id, word_progress);
+        }
+    }
+    return progress;
+}
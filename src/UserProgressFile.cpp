@@ -0,0 +1,282 @@
+#include "UserProgressFile.h"
+#include "GroupCommitWriter.h"
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char MAGIC[4] = {'W', 'P', 'R', 'G'};
+
+template <typename T>
+void put(string& out, T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template <typename T>
+T get(const string& in, size_t offset) {
+    T value;
+    memcpy(&value, in.data() + offset, sizeof(T));
+    return value;
+}
+
+}
+
+UserProgressFile::UserProgressFile(const string& users_dir, const VocabularyCatalog& catalog)
+    : USERS_DIR(users_dir), VOCAB_DIR(users_dir + ".vocab/"), catalog(&catalog) {
+    // 保存当前词表副本，供词表变化后解码旧文件
+    catalog.save_copy(VOCAB_DIR);
+}
+
+string UserProgressFile::get_data_file(const string& username) const {
+    return USERS_DIR + username + ".dat";
+}
+
+string UserProgressFile::get_legacy_file(const string& username) const {
+    return USERS_DIR + username + ".json";
+}
+
+bool UserProgressFile::exists(const string& username) const {
+    return fs::exists(get_data_file(username)) || fs::exists(get_legacy_file(username));
+}
+
+const VocabularyCatalog& UserProgressFile::get_catalog() const {
+    return *catalog;
+}
+
+bool UserProgressFile::load(const string& username, UserProgress& progress) const {
+    string data_file = get_data_file(username);
+    if (fs::exists(data_file)) {
+        ifstream file(data_file, ios::binary);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot open user data file for " << username << endl;
+            return false;
+        }
+        string bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        if (!decode(bytes, progress)) {
+            cerr << "Error: Corrupt user data file for " << username << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // 旧版 JSON 文件
+    ifstream file(get_legacy_file(username));
+    if (!file.is_open()) {
+        cerr << "Error: Cannot open user data file for " << username << endl;
+        return false;
+    }
+    try {
+        json user_data;
+        file >> user_data;
+        // 旧版文件为每个单词都保存了记录，内存中只保留非默认的单词
+        progress = UserProgress::from_json(user_data, *catalog);
+    } catch (const exception& e) {
+        cerr << "Error loading user data: " << e.what() << endl;
+        return false;
+    }
+    return true;
+}
+
+bool UserProgressFile::load_info(const string& username, json& user_info) const {
+    string data_file = get_data_file(username);
+    if (!fs::exists(data_file)) {
+        UserProgress progress;
+        if (!load(username, progress)) {
+            return false;
+        }
+        user_info = progress.user_info;
+        user_info["log_seq"] = progress.log_seq;
+        return true;
+    }
+
+    // 只读取文件头与 user_info，不解码记录数组
+    ifstream file(data_file, ios::binary);
+    string header(BASE_HEADER_SIZE, '\0');
+    if (!file.read(&header[0], BASE_HEADER_SIZE) || memcmp(header.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    if (get<uint16_t>(header, 4) >= 3) {
+        file.seekg(HEADER_SIZE);
+    }
+    string info_text(get<uint32_t>(header, 20), '\0');
+    if (!file.read(&info_text[0], info_text.size())) {
+        return false;
+    }
+    try {
+        user_info = json::parse(info_text);
+        user_info["log_seq"] = get<uint64_t>(header, 24);
+        return true;
+    } catch (const exception& e) {
+        cerr << "Error parsing user info: " << e.what() << endl;
+        return false;
+    }
+}
+
+bool UserProgressFile::save(const string& username, const UserProgress& progress) const {
+    // 临时文件 + fsync + 重命名，与同时到达的其他保存合并为一次成组提交
+    if (!GroupCommitWriter::instance().write(get_data_file(username), encode(progress))) {
+        return false;
+    }
+
+    // 迁移完成，删除旧版 JSON 文件
+    error_code ec;
+    fs::remove(get_legacy_file(username), ec);
+    return true;
+}
+
+void UserProgressFile::remove(const string& username) const {
+    error_code ec;
+    fs::remove(get_data_file(username), ec);
+    fs::remove(get_legacy_file(username), ec);
+}
+
+vector<string> UserProgressFile::list_users() const {
+    set<string> users;
+    for (const auto& entry : fs::directory_iterator(USERS_DIR)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        string extension = entry.path().extension().string();
+        if (extension == ".dat" || extension == ".json") {
+            users.insert(entry.path().stem().string());
+        }
+    }
+    return vector<string>(users.begin(), users.end());
+}
+
+string UserProgressFile::encode(const UserProgress& progress) const {
+    string info_text = progress.user_info.dump();
+
+    // 只写入有非默认计数的单词
+    const uint16_t* mistakes = progress.mistakes();
+    const uint16_t* correct = progress.correct();
+    const uint32_t* last_seen = progress.last_seen();
+    string records;
+    uint32_t record_count = 0;
+    for (uint32_t id = 0; id < progress.size(); id++) {
+        if (mistakes[id] == 0 && correct[id] == 0 && last_seen[id] == 0) {
+            continue;
+        }
+        put<uint32_t>(records, id);
+        put<uint16_t>(records, mistakes[id]);
+        put<uint16_t>(records, correct[id]);
+        put<uint32_t>(records, last_seen[id]);
+        record_count++;
+    }
+
+    string out;
+    out.reserve(HEADER_SIZE + info_text.size() + records.size());
+    out.append(MAGIC, sizeof(MAGIC));
+    put<uint16_t>(out, FORMAT_VERSION);
+    put<uint16_t>(out, RECORD_SIZE);
+    put<uint64_t>(out, catalog->fingerprint());
+    put<uint32_t>(out, record_count);
+    put<uint32_t>(out, info_text.size());
+    put<uint64_t>(out, progress.log_seq);
+    const ProgressTotals& totals = progress.get_totals();
+    put<uint32_t>(out, totals.review_count);
+    put<uint32_t>(out, 0);
+    put<uint64_t>(out, totals.total_mistakes);
+    put<uint64_t>(out, totals.total_correct);
+    out += info_text;
+    out += records;
+    return out;
+}
+
+bool UserProgressFile::decode(const string& bytes, UserProgress& progress) const {
+    if (bytes.size() < BASE_HEADER_SIZE || memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+
+    uint16_t version = get<uint16_t>(bytes, 4);
+    uint16_t record_size = get<uint16_t>(bytes, 6);
+    uint64_t file_fingerprint = get<uint64_t>(bytes, 8);
+    uint32_t record_count = get<uint32_t>(bytes, 16);
+    uint32_t info_length = get<uint32_t>(bytes, 20);
+    uint64_t log_seq = get<uint64_t>(bytes, 24);
+
+    // 版本1为稠密记录（按 id 排列，无 id 字段），版本2为稀疏记录
+    bool dense = version == 1;
+    if (version == 0 || version > FORMAT_VERSION ||
+        record_size < (dense ? DENSE_RECORD_SIZE : RECORD_SIZE)) {
+        return false;
+    }
+    size_t header_size = version >= 3 ? HEADER_SIZE : BASE_HEADER_SIZE;
+    size_t records_offset = header_size + info_length;
+    if (bytes.size() < records_offset + (size_t)record_count * record_size) {
+        return false;
+    }
+
+    // 文件写入时的词表，与当前词表不同时需要逐词映射 id
+    unique_ptr<VocabularyCatalog> file_catalog;
+    if (file_fingerprint != catalog->fingerprint()) {
+        file_catalog = VocabularyCatalog::load_copy(VOCAB_DIR, file_fingerprint);
+        if (!file_catalog) {
+            cerr << "Error: User data was written with an unknown vocabulary" << endl;
+            return false;
+        }
+    }
+    size_t file_vocabulary_size = file_catalog ? file_catalog->size() : catalog->size();
+    if (dense && record_count != file_vocabulary_size) {
+        return false;
+    }
+
+    progress = UserProgress(*catalog);
+    try {
+        progress.user_info = json::parse(bytes.substr(header_size, info_length));
+    } catch (const exception& e) {
+        cerr << "Error parsing user info: " << e.what() << endl;
+        return false;
+    }
+    progress.log_seq = log_seq;
+
+    for (uint32_t i = 0; i < record_count; i++) {
+        size_t offset = records_offset + (size_t)i * record_size;
+        uint32_t id = i;
+        if (!dense) {
+            id = get<uint32_t>(bytes, offset);
+            offset += 4;
+        }
+        if (id >= file_vocabulary_size) {
+            return false;
+        }
+        if (file_catalog) {
+            id = catalog->id_of(file_catalog->word(id));
+            if (id == VocabularyCatalog::NOT_FOUND) {
+                continue;   // 已从词表中删除的单词
+            }
+        }
+
+        WordProgress word;
+        word.mistakes = get<uint16_t>(bytes, offset);
+        word.correct_count = get<uint16_t>(bytes, offset + 2);
+        word.last_seen = get<uint32_t>(bytes, offset + 4);
+        progress.set(id, word);
+    }
+
+    // 核对文件中的统计计数（词表变化后计数本来就会不同，不再比对）
+    ProgressTotals actual = progress.recount();
+    if (version >= 3 && !file_catalog) {
+        ProgressTotals stored;
+        stored.review_count = get<uint32_t>(bytes, 32);
+        stored.total_mistakes = get<uint64_t>(bytes, 40);
+        stored.total_correct = get<uint64_t>(bytes, 48);
+        if (!(stored == actual)) {
+            cerr << "Warning: Stats counters in user data do not match records ("
+                 << stored.review_count << "/" << stored.total_mistakes << "/" << stored.total_correct
+                 << " vs " << actual.review_count << "/" << actual.total_mistakes << "/" << actual.total_correct
+                 << "), using recount" << endl;
+        }
+    }
+    progress.rebuild_totals();
+    return true;
+}
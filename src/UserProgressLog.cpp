@@ -0,0 +1,240 @@
+#include "UserProgressLog.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+#include <map>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * @brief 每个用户的进程级锁
+ */
+struct UserLocks {
+    mutex log_mutex;        ///< 日志追加/轮转/截断
+    mutex snapshot_mutex;   ///< 快照写入
+    bool tail_clean = false;    ///< 日志已确认以换行结尾（受 log_mutex 保护）
+};
+
+UserLocks& user_locks(const string& username) {
+    static mutex registry_mutex;
+    static map<string, unique_ptr<UserLocks>> registry;
+
+    lock_guard<mutex> lock(registry_mutex);
+    auto& entry = registry[username];
+    if (!entry) {
+        entry = make_unique<UserLocks>();
+    }
+    return *entry;
+}
+
+/**
+ * @brief 截掉日志末尾没有换行的残行（崩溃或写入失败留下的）
+ *
+ * 否则下一次追加会直接接在残行后面，两条记录合成一行，后一条随之丢失。
+ */
+void drop_torn_tail(const string& path) {
+    ifstream file(path, ios::binary | ios::ate);
+    if (!file.is_open()) {
+        return;
+    }
+    streamoff size = file.tellg();
+    streamoff end = size;
+    char c = '\n';
+    while (end > 0) {
+        file.seekg(end - 1);
+        if (!file.get(c) || c == '\n') {
+            break;
+        }
+        end--;
+    }
+    if (end == size) {
+        return;
+    }
+    file.close();
+
+    error_code ec;
+    fs::resize_file(path, end, ec);
+    if (ec) {
+        cerr << "Error: Cannot drop torn record from " << path << ": " << ec.message() << endl;
+    } else {
+        cerr << "Warning: Dropped " << (size - end) << " bytes of torn record from " << path << endl;
+    }
+}
+
+}
+
+UserProgressLog::UserProgressLog(const string& users_dir, const VocabularyCatalog& catalog)
+    : USERS_DIR(users_dir), catalog(&catalog) {}
+
+mutex& UserProgressLog::log_mutex(const string& username) {
+    return user_locks(username).log_mutex;
+}
+
+mutex& UserProgressLog::snapshot_mutex(const string& username) {
+    return user_locks(username).snapshot_mutex;
+}
+
+string UserProgressLog::get_log_file(const string& username) const {
+    return USERS_DIR + username + ".log";
+}
+
+string UserProgressLog::get_compacting_file(const string& username) const {
+    return USERS_DIR + username + ".log.compacting";
+}
+
+bool UserProgressLog::append(const string& username, const vector<Record>& records) {
+    if (records.empty()) {
+        return true;
+    }
+
+    // 先拼好全部记录，一次写入，避免半批记录交错
+    string buffer;
+    for (const Record& record : records) {
+        buffer += to_string(record.seq);
+        buffer += ' ';
+        buffer += record.op;
+        buffer += ' ';
+        buffer += to_string(record.value);
+        buffer += ' ';
+        buffer += to_string(record.timestamp);
+        buffer += ' ';
+        buffer += record.word_id == VocabularyCatalog::NOT_FOUND ? "-" : catalog->word(record.word_id);
+        buffer += '\n';
+    }
+
+    UserLocks& locks = user_locks(username);
+    lock_guard<mutex> lock(locks.log_mutex);
+    string log_file = get_log_file(username);
+    // 每个进程第一次追加前（以及上次追加失败后）检查末尾是否有残行
+    if (!locks.tail_clean) {
+        drop_torn_tail(log_file);
+        locks.tail_clean = true;
+    }
+
+    ofstream file(log_file, ios::app | ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error: Cannot open progress log for " << username << endl;
+        return false;
+    }
+
+    file.write(buffer.data(), buffer.size());
+    file.flush();
+    if (!file.good()) {
+        // 可能只写入了一部分，下次追加前重新检查
+        locks.tail_clean = false;
+        return false;
+    }
+    return true;
+}
+
+uint64_t UserProgressLog::replay_file(const string& path, const VocabularyCatalog& catalog,
+                                      uint64_t applied_seq, uint64_t last_seq,
+                                      const function<void(const Record&)>& apply) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        return last_seq;
+    }
+    // 序列号只增不减：不大于已重放的最大序列号的记录是重复写入的（追加失败后整批重试）
+    last_seq = max(last_seq, applied_seq);
+
+    string line;
+    while (getline(file, line)) {
+        // 没有换行结尾的末行是崩溃留下的残行，单词可能被截断成另一个单词，整行丢弃
+        if (file.eof()) {
+            break;
+        }
+        istringstream iss(line);
+        Record record;
+        // 解析失败的行直接忽略
+        if (!(iss >> record.seq >> record.op >> record.value >> record.timestamp)) {
+            continue;
+        }
+        iss.get();
+        string key;
+        if (!getline(iss, key) || key.empty()) {
+            continue;
+        }
+        if (record.seq <= last_seq) {
+            continue;
+        }
+        last_seq = record.seq;
+        if (record.op == OP_MISTAKE || record.op == OP_CORRECT) {
+            // 词表更新后已删除的单词不再计入
+            record.word_id = catalog.id_of(key);
+            if (record.word_id == VocabularyCatalog::NOT_FOUND) {
+                continue;
+            }
+        }
+
+        apply(record);
+    }
+
+    return last_seq;
+}
+
+uint64_t UserProgressLog::replay(const string& username, uint64_t applied_seq,
+                                 const function<void(const Record&)>& apply) const {
+    // 轮转出去的旧日志先于当前日志
+    uint64_t last_seq = replay_file(get_compacting_file(username), *catalog, applied_seq, applied_seq, apply);
+    return replay_file(get_log_file(username), *catalog, applied_seq, last_seq, apply);
+}
+
+bool UserProgressLog::truncate(const string& username) {
+    lock_guard<mutex> lock(log_mutex(username));
+
+    error_code ec;
+    fs::remove(get_compacting_file(username), ec);
+
+    string log_file = get_log_file(username);
+    if (!fs::exists(log_file)) {
+        return true;
+    }
+
+    ofstream file(log_file, ios::trunc);
+    return file.is_open();
+}
+
+bool UserProgressLog::rotate(const string& username) {
+    lock_guard<mutex> lock(log_mutex(username));
+
+    string compacting_file = get_compacting_file(username);
+    if (fs::exists(compacting_file)) {
+        return true;
+    }
+
+    string log_file = get_log_file(username);
+    error_code ec;
+    if (!fs::exists(log_file) || fs::file_size(log_file, ec) == 0) {
+        return false;
+    }
+
+    fs::rename(log_file, compacting_file, ec);
+    if (ec) {
+        cerr << "Error: Cannot rotate progress log for " << username << ": " << ec.message() << endl;
+        return false;
+    }
+    return true;
+}
+
+void UserProgressLog::remove_compacting(const string& username) {
+    lock_guard<mutex> lock(log_mutex(username));
+    error_code ec;
+    fs::remove(get_compacting_file(username), ec);
+}
+
+uintmax_t UserProgressLog::size(const string& username) const {
+    error_code ec;
+    uintmax_t bytes = fs::file_size(get_log_file(username), ec);
+    return ec ? 0 : bytes;
+}
+
+void UserProgressLog::remove(const string& username) {
+    lock_guard<mutex> lock(log_mutex(username));
+    error_code ec;
+    fs::remove(get_log_file(username), ec);
+    fs::remove(get_compacting_file(username), ec);
+}
@@ -0,0 +1,164 @@
+#include "VocabularyCatalog.h"
+#include "FileUtils.h"
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <cstdlib>
+
+namespace fs = std::filesystem;
+
+VocabularyCatalog::VocabularyCatalog(const string& words_file, const string& learn_order)
+    : word_list(read_words_file(words_file)) {
+    build_index(learn_order);
+}
+
+VocabularyCatalog::VocabularyCatalog(vector<string> words, const string& learn_order)
+    : word_list(std::move(words)) {
+    build_index(learn_order);
+}
+
+const VocabularyCatalog& VocabularyCatalog::instance() {
+    // 生产环境配置
+    static const VocabularyCatalog catalog(getenv("PRODUCTION") ?
+                                           "/var/www/word-app/data/words.txt" :
+                                           "data/words.txt",
+                                           getenv("LEARN_ORDER") ? getenv("LEARN_ORDER") : "alphabetical");
+    return catalog;
+}
+
+void VocabularyCatalog::build_index(const string& learn_order) {
+    word_ids.reserve(word_list.size());
+    for (uint32_t id = 0; id < word_list.size(); id++) {
+        word_ids.emplace(word_list[id], id);
+    }
+
+    alphabetical.resize(word_list.size());
+    for (uint32_t id = 0; id < word_list.size(); id++) {
+        alphabetical[id] = id;
+    }
+    sort(alphabetical.begin(), alphabetical.end(), [this](uint32_t a, uint32_t b) {
+        return word_list[a] < word_list[b];
+    });
+
+    ranks.resize(word_list.size());
+    for (uint32_t rank = 0; rank < alphabetical.size(); rank++) {
+        ranks[alphabetical[rank]] = rank;
+    }
+
+    if (learn_order == "file") {
+        file_order.resize(word_list.size());
+        for (uint32_t id = 0; id < word_list.size(); id++) {
+            file_order[id] = id;
+        }
+        use_file_order = true;
+    } else if (learn_order != "alphabetical") {
+        cerr << "Warning: Unknown learn order '" << learn_order << "', using alphabetical" << endl;
+    }
+
+    vocabulary_fingerprint = compute_fingerprint(word_list);
+}
+
+size_t VocabularyCatalog::size() const {
+    return word_list.size();
+}
+
+const string& VocabularyCatalog::word(uint32_t id) const {
+    return word_list[id];
+}
+
+uint32_t VocabularyCatalog::id_of(const string& word) const {
+    auto it = word_ids.find(word);
+    return it != word_ids.end() ? it->second : NOT_FOUND;
+}
+
+bool VocabularyCatalog::contains(const string& word) const {
+    return word_ids.count(word) > 0;
+}
+
+const vector<string>& VocabularyCatalog::words() const {
+    return word_list;
+}
+
+const vector<uint32_t>& VocabularyCatalog::sorted_ids() const {
+    return alphabetical;
+}
+
+const vector<uint32_t>& VocabularyCatalog::learn_order() const {
+    return use_file_order ? file_order : alphabetical;
+}
+
+const vector<uint32_t>& VocabularyCatalog::alphabetical_ranks() const {
+    return ranks;
+}
+
+uint64_t VocabularyCatalog::fingerprint() const {
+    return vocabulary_fingerprint;
+}
+
+string VocabularyCatalog::fingerprint_hex() const {
+    return to_hex(vocabulary_fingerprint);
+}
+
+bool VocabularyCatalog::save_copy(const string& vocab_dir) const {
+    if (word_list.empty()) {
+        return false;
+    }
+
+    string path = vocab_dir + fingerprint_hex() + ".txt";
+    if (fs::exists(path)) {
+        return true;
+    }
+
+    error_code ec;
+    fs::create_directories(vocab_dir, ec);
+    string content;
+    for (const string& word : word_list) {
+        content += word;
+        content += '\n';
+    }
+    if (!FileUtils::write_text_file_atomic(path, content)) {
+        cerr << "Warning: Cannot save vocabulary copy " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+unique_ptr<VocabularyCatalog> VocabularyCatalog::load_copy(const string& vocab_dir, uint64_t fingerprint) {
+    vector<string> words = read_words_file(vocab_dir + to_hex(fingerprint) + ".txt");
+    if (words.empty() || compute_fingerprint(words) != fingerprint) {
+        return nullptr;
+    }
+    return make_unique<VocabularyCatalog>(std::move(words));
+}
+
+vector<string> VocabularyCatalog::read_words_file(const string& words_file) {
+    vector<string> words;
+    ifstream file(words_file);
+    string word;
+    while (getline(file, word)) {
+        // 移除可能的回车符
+        word.erase(word.find_last_not_of(" \n\r\t") + 1);
+        if (!word.empty()) {
+            words.push_back(word);
+        }
+    }
+    return words;
+}
+
+uint64_t VocabularyCatalog::compute_fingerprint(const vector<string>& words) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const string& word : words) {
+        for (unsigned char c : word) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        hash = (hash ^ '\n') * 1099511628211ULL;
+    }
+    return hash;
+}
+
+string VocabularyCatalog::to_hex(uint64_t fingerprint) {
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)fingerprint);
+    return buffer;
+}
@@ -6,11 +6,25 @@
 #include <random>
 #include <cstdlib>
 #include <filesystem>
+#include <thread>
 #include <httplib.h>
 
 namespace fs = std::filesystem;
 
-WordApp::WordApp() {
+WordApp::WordApp(const DictionaryClient::Options& dictionary_options) : dictionary(dictionary_options) {
+    // 执行模式：locks（默认，请求线程直接执行并加用户读写锁）
+    // 或 actor（用户哈希到单线程分片执行，不加锁）
+    const char* mode = getenv("USER_EXECUTION_MODE");
+    if (mode && string(mode) == "actor") {
+        size_t shard_count = max(1u, thread::hardware_concurrency());
+        if (getenv("USER_ACTOR_SHARDS")) {
+            shard_count = max(1, atoi(getenv("USER_ACTOR_SHARDS")));
+        }
+        executor = make_unique<ShardExecutor>(shard_count);
+        data_manager.disable_user_locks(executor->shard_count());
+        cout << "✓ Actor execution mode with " << shard_count << " shards" << endl;
+    }
+    
     // 企业版初始化 - 使用模块化组件
     cout << "✓ WordApp core initialized with enterprise modules" << endl;
 }
@@ -20,29 +34,58 @@ void WordApp::initialize_data() {
     cout << "✓ Enterprise data management modules ready" << endl;
 }
 
-json WordApp::get_learn_words(int page, int words_per_page) {
+json WordApp::get_learn_words(UserContext& context, int page, int words_per_page) {
     // 使用 UserDataManager 获取学习单词，支持断点续传
-    return data_manager.get_learn_words(page, words_per_page);
+    return on_user_shard(context, [&] { return data_manager.get_learn_words(context, page, words_per_page); });
 }
 
 json WordApp::get_exam_words() {
     return data_manager.get_exam_words(20);
 }
 
-bool WordApp::update_mistakes_batch(const vector<string>& words_to_update) {
-    return data_manager.update_mistakes_batch(words_to_update);
+bool WordApp::update_mistakes_batch(UserContext& context, const vector<string>& words_to_update) {
+    return on_user_shard(context, [&] { return data_manager.update_mistakes_batch(context, words_to_update); });
+}
+
+json WordApp::get_review_words(UserContext& context, int page, int words_per_page) {
+    return on_user_shard(context, [&] { return data_manager.get_review_words(context, page, words_per_page); });
+}
+
+json WordApp::get_all_review_words(UserContext& context) {
+    return on_user_shard(context, [&] { return data_manager.get_all_review_words(context); });
+}
+
+json WordApp::get_stats(UserContext& context) {
+    return on_user_shard(context, [&] { return data_manager.get_stats(context); });
 }
 
-json WordApp::get_review_words(int page, int words_per_page) {
-    return data_manager.get_review_words(page, words_per_page);
+json WordApp::recount_stats(UserContext& context) {
+    return on_user_shard(context, [&] { return data_manager.recount_stats(context); });
 }
 
-json WordApp::get_all_review_words() {
-    return data_manager.get_all_review_words();
+json WordApp::get_cache_stats() {
+    return data_manager.get_cache_stats();
 }
 
-json WordApp::get_stats() {
-    return data_manager.get_stats();
+json WordApp::get_dictionary_stats() {
+    return dictionary.get_stats();
+}
+
+json WordApp::get_lock_stats() {
+    json result = data_manager.get_lock_stats();
+    result["execution_mode"] = executor ? "actor" : "locks";
+    if (executor) {
+        result["executor"] = executor->get_stats();
+    }
+    return result;
+}
+
+void WordApp::shutdown() {
+    // 先执行完已投递的操作，再落盘
+    if (executor) {
+        executor->stop();
+    }
+    data_manager.shutdown();
 }
 
 map<string, json> WordApp::get_local_dictionary() {
@@ -146,11 +189,21 @@ json WordApp::dictionary_search(const string& word) {
 
 // ===== 用户认证相关方法实现 =====
 
+void WordApp::load_and_record_login(const string& username) {
+    // 获取（可能从磁盘加载）与记录登录在同一次分片调度中完成
+    on_user_shard(username, [&] {
+        shared_ptr<UserContext> context = data_manager.acquire(username);
+        if (context) {
+            data_manager.record_login(*context);
+        }
+    });
+}
+
 json WordApp::login_user(const string& username) {
     json result = auth_manager.login(username);
     if (result["success"].get<bool>()) {
-        // 登录成功，切换数据管理器到该用户
-        data_manager.set_current_user(username);
+        // 登录成功，加载该用户的上下文并记录登录
+        load_and_record_login(username);
     }
     return result;
 }
@@ -159,34 +212,46 @@ json WordApp::register_user(const string& username) {
     return auth_manager.register_user(username);
 }
 
-json WordApp::get_current_user() {
-    return auth_manager.get_current_user_info();
+shared_ptr<UserContext> WordApp::get_user_context(const string& token) {
+    string username = auth_manager.resolve_session(token);
+    if (username.empty()) {
+        return nullptr;
+    }
+    return on_user_shard(username, [&] { return data_manager.acquire(username); });
 }
 
-json WordApp::switch_user(const string& username) {
-    json result = auth_manager.switch_user(username);
-    if (result["success"].get<bool>()) {
-        // 切换成功，更新数据管理器
-        data_manager.set_current_user(username);
-    }
-    return result;
+json WordApp::get_current_user(const string& token) {
+    return auth_manager.get_user_info(auth_manager.resolve_session(token));
 }
 
-json WordApp::logout_user() {
-    json result = auth_manager.logout();
-    if (result["success"].get<bool>()) {
-        // 登出成功，清空数据管理器
-        data_manager.set_current_user("");
+json WordApp::switch_user(const string& token, const string& username) {
+    json result = auth_manager.switch_user(token, username);
+    if (result["success"].get<bool>() && result["session_token"] != token) {
+        // 切换成功，加载新用户；原用户的上下文留在缓存中，由 LRU 决定何时淘汰
+        load_and_record_login(username);
     }
     return result;
 }
 
-json WordApp::get_user_list() {
-    return auth_manager.get_user_list();
+json WordApp::logout_user(const string& token) {
+    return auth_manager.logout(token);
+}
+
+json WordApp::get_user_list(const string& token) {
+    return auth_manager.get_user_list(auth_manager.resolve_session(token));
 }
 
 json WordApp::delete_user(const string& username) {
-    return auth_manager.delete_user(username);
+    // 先释放缓存与写回缓冲，再删除文件，避免已删除的用户被写回
+    return auth_manager.delete_user(username, [this, &username] {
+        on_user_shard(username, [&] { data_manager.evict(username); });
+    });
+}
+
+json WordApp::get_user_stats(const string& username) {
+    return auth_manager.get_user_stats(username, [this, &username](ProgressTotals& totals, json& user_info) {
+        return on_user_shard(username, [&] { return data_manager.read_resident(username, totals, user_info); });
+    });
 }
 
 // ===== 词典API集成 =====
@@ -354,30 +419,15 @@ json WordApp::query_iciba_api(const string& word) {
         cout << "[DEBUG] Querying Iciba API for: " << word << endl;
         
         // 使用有道词典API（备用方案）和金山词霸
-        string url = "https://fanyi.youdao.com/openapi.do?keyfrom=dict&key=null&type=data&doctype=json&version=1.1&q=" + word;
-        cout << "[DEBUG] Request URL: " << url << endl;
-        
-        // 使用curl命令获取数据，设置用户代理和较短超时
-        string cmd = "curl -s -L --connect-timeout 5 --max-time 8 -X GET \"" + url + "\" -H \"Accept: application/json\" -H \"User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36\" 2>/dev/null";
-        
-        FILE* pipe = popen(cmd.c_str(), "r");
-        if (!pipe) {
-            cout << "[DEBUG] Failed to execute curl command" << endl;
-            return json{{"success", false}, {"error", "Failed to execute curl command"}};
-        }
-        
-        // 读取curl输出
-        string response_body;
-        char buffer[128];
-        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-            response_body += buffer;
-        }
-        
-        int status = pclose(pipe);
+        string path = "/openapi.do?keyfrom=dict&key=null&type=data&doctype=json&version=1.1&q=" +
+                      DictionaryClient::url_encode(word);
+        cout << "[DEBUG] Request path: " << path << endl;
         
-        if (status != 0) {
-            cout << "[DEBUG] Curl command failed with status: " << status << endl;
-            return json{{"success", false}, {"error", "Network request failed"}};
+        // 通过连接池复用 keep-alive 连接，不再为每次查询启动 curl
+        string response_body, error;
+        if (!dictionary.get(path, response_body, error)) {
+            cout << "[DEBUG] Dictionary request failed: " << error << endl;
+            return json{{"success", false}, {"error", error}};
         }
         
         // 检查响应体
@@ -608,7 +658,7 @@ json WordApp::convert_iciba_response(const string& word, const json& iciba_data)
 
 // ===== 用户数据管理方法实现 =====
 
-json WordApp::reset_user_progress(bool reset_mistakes, bool reset_position) {
-    return data_manager.reset_progress(reset_mistakes, reset_position);
+json WordApp::reset_user_progress(UserContext& context, bool reset_mistakes, bool reset_position) {
+    return on_user_shard(context, [&] { return data_manager.reset_progress(context, reset_mistakes, reset_position); });
 }
 
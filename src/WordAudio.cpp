@@ -0,0 +1,272 @@
+#include "WordAudio.h"
+#include <cstdio>
+#include <algorithm>
+
+void WordAudio::Body::append(string_view part) {
+    parts.push_back(part);
+    size += part.size();
+}
+
+void WordAudio::Body::append(shared_ptr<const string> part) {
+    append(string_view(*part));
+    owners.push_back(move(part));
+}
+
+void WordAudio::Body::add_digest(uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        digest = (digest ^ (value & 0xff)) * 1099511628211ull;
+        value >>= 8;
+    }
+}
+
+string WordAudio::Body::etag() const {
+    char text[24];
+    snprintf(text, sizeof(text), "\"%016llx\"", (unsigned long long)digest);
+    return text;
+}
+
+bool WordAudio::Body::write(size_t offset, size_t length, const function<bool(const char*, size_t)>& write) const {
+    for (string_view part : parts) {
+        if (length == 0) {
+            break;
+        }
+        if (offset >= part.size()) {
+            offset -= part.size();
+            continue;
+        }
+        size_t count = min(length, part.size() - offset);
+        if (!write(part.data() + offset, count)) {
+            return false;
+        }
+        offset = 0;
+        length -= count;
+    }
+    return length == 0;
+}
+
+WordAudio::WordAudio(const AudioPack& pack, int speed, size_t cache_entries)
+    : pack(nullptr), engine(SpeechEngine::instance()), speed(speed), cache_entries(cache_entries) {
+    // 序列需要拼接 PCM，采样率不一致的音频包不能与现场合成的音频混用
+    if (pack.is_open() && pack.sample_rate() == engine.sample_rate()) {
+        this->pack = &pack;
+    }
+}
+
+int WordAudio::sample_rate() const {
+    return engine.sample_rate();
+}
+
+bool WordAudio::lookup(const string& word, string_view& wav, shared_ptr<const string>& owner, uint64_t& hash) {
+    if (pack) {
+        wav = pack->find(word, hash);
+        if (!wav.empty()) {
+            pack_hits++;
+            return true;
+        }
+    }
+    
+    lock_guard<mutex> lock(cache_mutex);
+    auto it = cache.find(word);
+    if (it == cache.end()) {
+        return false;
+    }
+    cache_hits++;
+    owner = it->second.wav;
+    hash = it->second.hash;
+    wav = *owner;
+    return true;
+}
+
+bool WordAudio::find(const string& word, Body& body) {
+    string_view wav;
+    shared_ptr<const string> owner;
+    uint64_t hash;
+    if (!lookup(word, wav, owner, hash)) {
+        return false;
+    }
+    body.add_digest(hash);
+    if (owner) {
+        body.append(move(owner));
+    } else {
+        body.append(wav);
+    }
+    return true;
+}
+
+bool WordAudio::get(const string& word, Body& body) {
+    if (find(word, body)) {
+        return true;
+    }
+    
+    vector<int16_t> samples;
+    if (!engine.synthesize(word, speed, samples)) {
+        failures++;
+        return false;
+    }
+    synthesized++;
+    auto wav = make_shared<const string>(SpeechEngine::encode_wav(samples, engine.sample_rate()));
+    CachedClip clip{wav, AudioPack::content_hash(*wav)};
+    
+    {
+        lock_guard<mutex> lock(cache_mutex);
+        // 并发请求同一单词时可能各自合成一次，保留先放入的结果
+        auto inserted = cache.emplace(word, clip);
+        if (inserted.second) {
+            cache_order.push_back(word);
+            while (cache_order.size() > cache_entries) {
+                cache.erase(cache_order.front());
+                cache_order.pop_front();
+            }
+        } else {
+            clip = inserted.first->second;
+        }
+    }
+    body.add_digest(clip.hash);
+    body.append(move(clip.wav));
+    return true;
+}
+
+bool WordAudio::find_sequence(const vector<string>& words, int pause_ms, Body& body) {
+    Body clips;
+    for (const string& word : words) {
+        if (!find(word, clips)) {
+            return false;
+        }
+    }
+    
+    shared_ptr<const string> gap = silence(pause_ms);
+    size_t data_size = 0;
+    for (size_t i = 0; i < clips.parts.size(); i++) {
+        data_size += clips.parts[i].size() - AudioPack::WAV_HEADER_SIZE + (i > 0 ? gap->size() : 0);
+    }
+    
+    // 序列的内容由各单词音频与停顿决定，ETag 由它们的哈希组合，不需要哈希拼接后的内容
+    body.digest = clips.digest;
+    body.add_digest(gap->size());
+    body.append(make_shared<const string>(SpeechEngine::wav_header(data_size, engine.sample_rate())));
+    for (size_t i = 0; i < clips.parts.size(); i++) {
+        if (i > 0) {
+            body.append(gap);
+        }
+        body.append(clips.parts[i].substr(AudioPack::WAV_HEADER_SIZE));
+    }
+    body.owners.insert(body.owners.end(), clips.owners.begin(), clips.owners.end());
+    return true;
+}
+
+bool WordAudio::get_samples(const string& word, Body& body) {
+    Body clip;
+    if (!get(word, clip)) {
+        return false;
+    }
+    body.append(clip.parts[0].substr(AudioPack::WAV_HEADER_SIZE));
+    body.owners.insert(body.owners.end(), clip.owners.begin(), clip.owners.end());
+    return true;
+}
+
+shared_ptr<const string> WordAudio::silence(int milliseconds) {
+    milliseconds = max(0, min(milliseconds, MAX_PAUSE_MS));
+    lock_guard<mutex> lock(cache_mutex);
+    shared_ptr<const string>& bytes = silences[milliseconds];
+    if (!bytes) {
+        bytes = make_shared<const string>((size_t)engine.sample_rate() * milliseconds / 1000 * sizeof(int16_t), '\0');
+    }
+    return bytes;
+}
+
+json WordAudio::get_stats() const {
+    size_t cached;
+    {
+        lock_guard<mutex> lock(cache_mutex);
+        cached = cache.size();
+    }
+    return {
+        {"pack_words", pack ? pack->size() : 0},
+        {"pack_hits", pack_hits.load()},
+        {"cached_words", cached},
+        {"cache_hits", cache_hits.load()},
+        {"synthesized", synthesized.load()},
+        {"failures", failures.load()}
+    };
+}
+
+vector<string> WordAudio::split_words(const string& text) {
+    vector<string> words;
+    string word;
+    for (char c : text) {
+        if (c == ' ' || c == ',' || c == '\t' || c == '\n' || c == '\r') {
+            if (!word.empty()) {
+                words.push_back(move(word));
+                word.clear();
+            }
+        } else {
+            word += c;
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(move(word));
+    }
+    return words;
+}
+
+WordAudio::Pipeline::Pipeline(WordAudio& audio, vector<string> words, int pause_ms, size_t lookahead)
+    : audio(audio), words(move(words)), gap(audio.silence(pause_ms)), lookahead(max<size_t>(1, lookahead)) {
+    producer = thread(&Pipeline::run_producer, this);
+}
+
+WordAudio::Pipeline::~Pipeline() {
+    {
+        lock_guard<mutex> lock(ready_mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    producer.join();
+}
+
+void WordAudio::Pipeline::run_producer() {
+    for (const string& word : words) {
+        {
+            unique_lock<mutex> lock(ready_mutex);
+            changed.wait(lock, [this] { return stopping || ready.size() < lookahead; });
+            if (stopping) {
+                return;
+            }
+        }
+        
+        // 合成时不持锁，调用者可以同时发送前一个单词
+        Body body;
+        audio.get_samples(word, body);
+        
+        {
+            lock_guard<mutex> lock(ready_mutex);
+            ready.push_back(move(body));
+        }
+        changed.notify_all();
+    }
+}
+
+bool WordAudio::Pipeline::next(Body& body) {
+    if (taken == words.size()) {
+        return false;
+    }
+    
+    Body word;
+    {
+        unique_lock<mutex> lock(ready_mutex);
+        changed.wait(lock, [this] { return !ready.empty(); });
+        word = move(ready.front());
+        ready.pop_front();
+    }
+    changed.notify_all();
+    
+    if (taken == 0) {
+        body.append(make_shared<const string>(SpeechEngine::wav_header(SpeechEngine::STREAMING_SIZE, audio.sample_rate())));
+    } else {
+        body.append(gap);
+    }
+    body.parts.insert(body.parts.end(), word.parts.begin(), word.parts.end());
+    body.owners.insert(body.owners.end(), word.owners.begin(), word.owners.end());
+    body.size += word.size;
+    taken++;
+    return true;
+}
@@ -0,0 +1,131 @@
+#include "WordReaderClient.h"
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+
+namespace {
+
+bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool read_all(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t count = recv(fd, data, size, 0);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        size -= count;
+    }
+    return true;
+}
+
+}
+
+WordReaderClient::WordReaderClient(const string& socket_path) : socket_path(socket_path) {}
+
+WordReaderClient::~WordReaderClient() {
+    lock_guard<mutex> lock(client_mutex);
+    close_locked();
+}
+
+const string& WordReaderClient::path() const {
+    return socket_path;
+}
+
+bool WordReaderClient::write_frame(int fd, const string& payload) {
+    if (payload.size() > MAX_FRAME) {
+        return false;
+    }
+    uint32_t size = payload.size();
+    unsigned char header[4] = {
+        (unsigned char)(size >> 24), (unsigned char)(size >> 16), (unsigned char)(size >> 8), (unsigned char)size
+    };
+    // 帧头与内容一次发出，避免小包分两次发送
+    string frame(reinterpret_cast<const char*>(header), sizeof(header));
+    frame += payload;
+    return write_all(fd, frame.data(), frame.size());
+}
+
+bool WordReaderClient::read_frame(int fd, string& payload) {
+    unsigned char header[4];
+    if (!read_all(fd, reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    uint32_t size = (uint32_t)header[0] << 24 | (uint32_t)header[1] << 16 | (uint32_t)header[2] << 8 | header[3];
+    if (size > MAX_FRAME) {
+        return false;
+    }
+    payload.resize(size);
+    return size == 0 || read_all(fd, &payload[0], size);
+}
+
+bool WordReaderClient::connect_locked() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        cerr << "Error: Socket path too long: " << socket_path << endl;
+        return false;
+    }
+    strcpy(address.sun_path, socket_path.c_str());
+    
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    // 守护进程排队后立即回复，回复迟迟不来说明它已卡住
+    timeval timeout{2, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close_locked();
+        return false;
+    }
+    return true;
+}
+
+void WordReaderClient::close_locked() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool WordReaderClient::request(const string& command, string& reply) {
+    lock_guard<mutex> lock(client_mutex);
+    // 复用的连接可能已被守护进程重启断开，失败时重连一次
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = fd >= 0;
+        if (!reused && !connect_locked()) {
+            return false;
+        }
+        if (write_frame(fd, command) && read_frame(fd, reply)) {
+            return true;
+        }
+        close_locked();
+        if (!reused) {
+            break;
+        }
+    }
+    return false;
+}
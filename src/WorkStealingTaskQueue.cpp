@@ -0,0 +1,216 @@
+#include "WorkStealingTaskQueue.h"
+
+namespace {
+
+template <typename T>
+void update_max(atomic<T>& maximum, T value) {
+    T current = maximum.load(memory_order_relaxed);
+    while (value > current && !maximum.compare_exchange_weak(current, value, memory_order_relaxed)) {
+    }
+}
+
+}
+
+WorkStealingTaskQueue::BlockingScope::BlockingScope() : queue(current_queue) {
+    if (queue) {
+        // 嵌套的慢处理区不再重复让出名额
+        current_queue = nullptr;
+        queue->begin_blocking();
+    }
+}
+
+WorkStealingTaskQueue::BlockingScope::~BlockingScope() {
+    if (queue) {
+        queue->end_blocking();
+        current_queue = queue;
+    }
+}
+
+WorkStealingTaskQueue::WorkStealingTaskQueue(size_t worker_count, size_t max_queued, size_t spare_count)
+    : worker_count(worker_count > 0 ? worker_count : 1), max_queued(max_queued),
+      local_queues(new LocalQueue[this->worker_count]) {
+    for (size_t i = 0; i < this->worker_count + spare_count; i++) {
+        threads.emplace_back(&WorkStealingTaskQueue::run_worker, this, i);
+    }
+}
+
+WorkStealingTaskQueue::~WorkStealingTaskQueue() {
+    shutdown();
+}
+
+bool WorkStealingTaskQueue::enqueue(function<void()> fn) {
+    if (stopping.load()) {
+        rejected_count.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    size_t length = queued.fetch_add(1) + 1;
+    if (max_queued > 0 && length > max_queued) {
+        queued.fetch_sub(1);
+        rejected_count.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    
+    // 两个候选队列取较短的一个，某个线程卡在慢请求上时新连接不会继续堆到它的队列
+    size_t first = next_queue.fetch_add(1, memory_order_relaxed) % worker_count;
+    size_t second = (first + 1) % worker_count;
+    LocalQueue& local = local_queues[first].size.load(memory_order_relaxed) <=
+                        local_queues[second].size.load(memory_order_relaxed)
+                        ? local_queues[first] : local_queues[second];
+    {
+        // ready 与放入任务在同一把锁内增加：任务只能在解锁后被取走，取走时的减一不会先于这里的加一，
+        // ready 不会回绕成 SIZE_MAX 而让等待条件误判为有任务
+        lock_guard<mutex> queue_lock(local.queue_mutex);
+        local.tasks.push_back({std::move(fn), chrono::steady_clock::now()});
+        local.size.fetch_add(1, memory_order_relaxed);
+        ready.fetch_add(1);
+    }
+    enqueued_count.fetch_add(1, memory_order_relaxed);
+    update_max(max_queue_length, length);
+    notify_sleeper();
+    return true;
+}
+
+void WorkStealingTaskQueue::shutdown() {
+    {
+        lock_guard<mutex> lock(idle_mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (thread& worker : threads) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool WorkStealingTaskQueue::take(size_t index, Task& task) {
+    if (index < worker_count) {
+        LocalQueue& local = local_queues[index];
+        if (local.size.load(memory_order_relaxed) > 0) {
+            lock_guard<mutex> lock(local.queue_mutex);
+            if (!local.tasks.empty()) {
+                task = std::move(local.tasks.front());
+                local.tasks.pop_front();
+                local.size.fetch_sub(1, memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    
+    for (size_t i = 1; i <= worker_count; i++) {
+        LocalQueue& victim = local_queues[(index + i) % worker_count];
+        if (victim.size.load(memory_order_relaxed) == 0) {
+            continue;
+        }
+        lock_guard<mutex> lock(victim.queue_mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            victim.size.fetch_sub(1, memory_order_relaxed);
+            steal_count.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingTaskQueue::claim_slot() {
+    size_t current = active.load();
+    while (current < worker_count) {
+        if (active.compare_exchange_weak(current, current + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingTaskQueue::release_slot() {
+    active.fetch_sub(1);
+    if (ready.load() > 0) {
+        notify_sleeper();
+    }
+}
+
+void WorkStealingTaskQueue::notify_sleeper() {
+    // 睡眠的线程先增加 sleeping 再检查条件，放入任务或归还名额的一方先改计数再读 sleeping，
+    // 两边总有一方看到对方的修改；加一次锁保证通知不会落在检查条件与开始等待之间
+    if (sleeping.load() > 0) {
+        { lock_guard<mutex> lock(idle_mutex); }
+        wakeup.notify_one();
+    }
+}
+
+bool WorkStealingTaskQueue::wait_for_work() {
+    unique_lock<mutex> lock(idle_mutex);
+    sleeping.fetch_add(1);
+    wakeup.wait(lock, [this] {
+        return (ready.load() > 0 && active.load() < worker_count) || (stopping.load() && ready.load() == 0);
+    });
+    sleeping.fetch_sub(1);
+    return !(stopping.load() && ready.load() == 0);
+}
+
+void WorkStealingTaskQueue::run_worker(size_t index) {
+    current_queue = this;
+    while (true) {
+        // 认领名额后连续取任务，取不到（已被其他线程取走）时才归还名额重新等待
+        if (claim_slot()) {
+            Task task;
+            while (take(index, task)) {
+                ready.fetch_sub(1);
+                queued.fetch_sub(1);
+                
+                uint64_t wait_us = chrono::duration_cast<chrono::microseconds>(
+                    chrono::steady_clock::now() - task.enqueued).count();
+                total_wait_us.fetch_add(wait_us, memory_order_relaxed);
+                update_max(max_wait_us, wait_us);
+                
+                task.fn();
+                task.fn = nullptr;
+                completed_count.fetch_add(1, memory_order_relaxed);
+            }
+            release_slot();
+        }
+        if (!wait_for_work()) {
+            break;
+        }
+    }
+    current_queue = nullptr;
+}
+
+void WorkStealingTaskQueue::begin_blocking() {
+    size_t now_blocked = blocked.fetch_add(1) + 1;
+    update_max(max_blocked, now_blocked);
+    // 让出的名额交给空闲线程处理排队中的连接
+    release_slot();
+}
+
+void WorkStealingTaskQueue::end_blocking() {
+    // 慢处理结束后直接继续执行，不等名额（短时间内可能超过 worker_count）
+    active.fetch_add(1);
+    blocked.fetch_sub(1);
+}
+
+json WorkStealingTaskQueue::get_stats() const {
+    size_t queue_length = ready.load();
+    size_t active_now = active.load();
+    size_t blocked_now = blocked.load();
+    uint64_t completed = completed_count.load(memory_order_relaxed);
+    uint64_t total_wait = total_wait_us.load(memory_order_relaxed);
+    return {
+        {"workers", worker_count},
+        {"spare_threads", threads.size() - worker_count},
+        {"max_queue", max_queued},
+        {"queue_length", queue_length},
+        {"max_queue_length", max_queue_length.load(memory_order_relaxed)},
+        {"active", active_now},
+        {"blocked", blocked_now},
+        {"max_blocked", max_blocked.load(memory_order_relaxed)},
+        {"enqueued", enqueued_count.load(memory_order_relaxed)},
+        {"rejected", rejected_count.load(memory_order_relaxed)},
+        {"completed", completed},
+        {"steals", steal_count.load(memory_order_relaxed)},
+        {"avg_wait_us", completed > 0 ? (double)total_wait / completed : 0.0},
+        {"max_wait_us", max_wait_us.load(memory_order_relaxed)}
+    };
+}
@@ -8,6 +8,7 @@
 
 #include "WordApp.h"
 #include "HttpServer.h"
+#include "ServerConfig.h"
 #include <iostream>
 #include <memory>
 #include <signal.h>
@@ -17,23 +18,39 @@ using namespace std;
 // 全局服务器指针，用于信号处理
 std::shared_ptr<HttpServer> global_server;
 
+// 服务器启动前收到的退出信号
+volatile sig_atomic_t shutdown_requested = 0;
+
 /**
  * @brief 信号处理函数，优雅地关闭服务器
  * @param signum 信号编号
  */
 void signal_handler(int signum) {
     cout << "\nReceived signal " << signum << ". Shutting down gracefully..." << endl;
+    shutdown_requested = 1;
+    // 只让 listen 返回，由 main 落盘后正常退出
     if (global_server) {
         global_server->stop();
     }
-    exit(0);
 }
 
 /**
  * @brief 主程序入口
+ * @param argc 参数个数
+ * @param argv 参数数组（--config、--host、--port、--threads 等，见 --help）
  * @return 程序退出码
  */
-int main() {
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    if (!config.parse_args(argc, argv)) {
+        cerr << ServerConfig::usage(argv[0]);
+        return 1;
+    }
+    if (config.help) {
+        cout << ServerConfig::usage(argv[0]);
+        return 0;
+    }
+    
     try {
         // 设置信号处理
         signal(SIGINT, signal_handler);
@@ -44,19 +61,36 @@ int main() {
         cout << "===========================================" << endl;
         
         // 创建应用实例
-        auto app = make_shared<WordApp>();
+        DictionaryClient::Options dictionary;
+        if (!config.dictionary_url.empty()) {
+            dictionary.base_url = config.dictionary_url;
+        }
+        dictionary.connect_timeout_ms = config.dictionary_connect_timeout_ms;
+        dictionary.read_timeout_ms = config.dictionary_read_timeout_ms;
+        dictionary.max_connections = config.dictionary_connections;
+#ifndef CPPHTTPLIB_OPENSSL_SUPPORT
+        if (dictionary.base_url.rfind("https://", 0) == 0) {
+            cerr << "Warning: Built without OpenSSL, online dictionary " << dictionary.base_url
+                 << " is unavailable; use --dictionary-url to set an http address" << endl;
+        }
+#endif
+        auto app = make_shared<WordApp>(dictionary);
         cout << "✓ WordApp initialized successfully" << endl;
         
         // 创建HTTP服务器
-        global_server = make_shared<HttpServer>(app);
+        global_server = make_shared<HttpServer>(app, config);
         cout << "✓ HttpServer initialized successfully" << endl;
         
         // 启动服务器
-        const string host = "0.0.0.0";
-        const int port = 8080;
-        
         cout << "✓ Starting server..." << endl;
-        if (!global_server->start(host, port)) {
+        bool started = shutdown_requested || global_server->start();
+        
+        // 服务器已停止，落盘所有未保存的学习进度
+        cout << "✓ Flushing user data..." << endl;
+        app->shutdown();
+        global_server.reset();
+        
+        if (!started) {
             cerr << "✗ Failed to start server" << endl;
             return 1;
         }
@@ -0,0 +1,114 @@
+/**
+ * @file DictionaryClientTest.cpp
+ * @brief 在线词典连接池测试：并发连接数上限、连接复用、失败连接的替换
+ *
+ * 使用 tests/mock/httplib.h 替代真实的 httplib，不访问网络。
+ */
+
+#include "DictionaryClient.h"
+#include "TestSupport.h"
+#include <httplib.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+DictionaryClient::Options local_options(size_t max_connections) {
+    DictionaryClient::Options options;
+    options.base_url = "http://127.0.0.1:9000";
+    options.max_connections = max_connections;
+    return options;
+}
+
+/**
+ * @brief 响应体开头的连接序号
+ */
+int connection_of(const string& body) {
+    return stoi(body.substr(0, body.find(' ')));
+}
+
+void test_peak_concurrency() {
+    httplib::mock::reset();
+    httplib::mock::request_ms = 20;
+    DictionaryClient client(local_options(3));
+
+    vector<thread> threads;
+    atomic<int> succeeded{0};
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&client, &succeeded, t] {
+            for (int i = 0; i < 5; i++) {
+                string body, error;
+                if (client.get("/q?w=" + to_string(t * 5 + i), body, error)) {
+                    succeeded++;
+                }
+            }
+        });
+    }
+    for (thread& worker : threads) {
+        worker.join();
+    }
+
+    // 8 个线程共用 3 条连接：同时进行的请求不超过上限，也不会多建连接
+    CHECK_EQ(succeeded.load(), 40);
+    CHECK_EQ(httplib::mock::peak_in_flight.load(), 3);
+    CHECK_EQ(httplib::mock::clients_created.load(), 3);
+    json stats = client.get_stats();
+    CHECK_EQ(stats["open_connections"].get<size_t>(), 3u);
+    CHECK_EQ(stats["idle_connections"].get<size_t>(), 3u);
+    CHECK_EQ(stats["failures"].get<uint64_t>(), 0u);
+    CHECK(stats["waits"].get<uint64_t>() > 0);
+}
+
+void test_failed_connection_replaced() {
+    httplib::mock::reset();
+    DictionaryClient client(local_options(1));
+    string body, error;
+
+    CHECK(client.get("/first", body, error));
+    int first = connection_of(body);
+    CHECK(client.get("/second", body, error));
+    CHECK_EQ(connection_of(body), first);
+
+    // 非 2xx 响应不影响连接，继续复用
+    CHECK(!client.get("/status500", body, error));
+    CHECK_EQ(error, "HTTP status 500");
+    CHECK(client.get("/third", body, error));
+    CHECK_EQ(connection_of(body), first);
+
+    // 网络错误的连接被丢弃，下一次请求新建连接，连接数不泄漏
+    CHECK(!client.get("/fail", body, error));
+    CHECK(error.find("Network request failed") == 0);
+    CHECK_EQ(client.get_stats()["open_connections"].get<size_t>(), 0u);
+    CHECK(client.get("/fourth", body, error));
+    CHECK(connection_of(body) != first);
+    CHECK_EQ(httplib::mock::clients_created.load(), 2);
+
+    json stats = client.get_stats();
+    CHECK_EQ(stats["requests"].get<uint64_t>(), 6u);
+    CHECK_EQ(stats["failures"].get<uint64_t>(), 2u);
+    CHECK_EQ(stats["open_connections"].get<size_t>(), 1u);
+}
+
+void test_https_default() {
+    httplib::mock::reset();
+    DictionaryClient::Options options;
+    CHECK(options.base_url.rfind("https://", 0) == 0);
+
+#ifndef CPPHTTPLIB_OPENSSL_SUPPORT
+    // 没有 OpenSSL 时不降级为 http，查询直接失败并归还连接名额
+    DictionaryClient client(options);
+    string body, error;
+    CHECK(!client.get("/q", body, error));
+    CHECK(error.find("requires OpenSSL support") != string::npos);
+    CHECK_EQ(client.get_stats()["open_connections"].get<size_t>(), 0u);
+#endif
+}
+
+}
+
+int main() {
+    test_peak_concurrency();
+    test_failed_connection_replaced();
+    test_https_default();
+    return test_result("DictionaryClientTest");
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <filesystem>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * @brief 测试程序共用的断言与临时目录
+ *
+ * 每个测试程序是一个独立的可执行文件，由 ctest 运行；CHECK 失败时输出位置并计数，
+ * main 返回 test_failures() 非零即为失败。
+ */
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " << #condition << endl; \
+            test_failures()++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto actual_value = (actual); \
+        auto expected_value = (expected); \
+        if (!(actual_value == expected_value)) { \
+            cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ failed: " << #actual << " == " << #expected \
+                 << " (" << actual_value << " vs " << expected_value << ")" << endl; \
+            test_failures()++; \
+        } \
+    } while (0)
+
+/**
+ * @brief 测试用的临时目录，析构时删除
+ */
+class TempDir {
+public:
+    explicit TempDir(const string& name) {
+        path = (filesystem::temp_directory_path() / (name + "_" + to_string(getpid()))).string() + "/";
+        filesystem::remove_all(path);
+        filesystem::create_directories(path);
+    }
+
+    ~TempDir() {
+        error_code ec;
+        filesystem::remove_all(path, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    string path;    ///< 目录路径（以 / 结尾）
+};
+
+/**
+ * @brief 输出测试结果
+ * @param name 测试名
+ * @return 进程退出码
+ */
+inline int test_result(const string& name) {
+    if (test_failures() > 0) {
+        cerr << name << ": " << test_failures() << " check(s) failed" << endl;
+        return 1;
+    }
+    cout << name << ": all checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file UserProgressFileTest.cpp
+ * @brief .dat 格式测试：版本1/2/3 的读取、当前版本的往返，以及词表变化后的 id 映射
+ */
+
+#include "UserProgressFile.h"
+#include "TestSupport.h"
+#include <cstring>
+
+namespace {
+
+template <typename T>
+void put(string& out, T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+/**
+ * @brief 按版本1、2的 32 字节文件头编码（records 为已编码的记录数组）
+ */
+string encode_base_header(uint16_t version, uint16_t record_size, uint64_t fingerprint, uint32_t record_count,
+                          const string& info_text, uint64_t log_seq, const string& records) {
+    string out("WPRG", 4);
+    put<uint16_t>(out, version);
+    put<uint16_t>(out, record_size);
+    put<uint64_t>(out, fingerprint);
+    put<uint32_t>(out, record_count);
+    put<uint32_t>(out, info_text.size());
+    put<uint64_t>(out, log_seq);
+    out += info_text;
+    out += records;
+    return out;
+}
+
+void put_counts(string& out, uint16_t mistakes, uint16_t correct, uint32_t last_seen) {
+    put<uint16_t>(out, mistakes);
+    put<uint16_t>(out, correct);
+    put<uint32_t>(out, last_seen);
+}
+
+const vector<string> WORDS = {"apple", "banana", "cherry", "ozone layer"};
+
+void test_round_trip(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressFile file(users_dir, catalog);
+
+    UserProgress progress(catalog);
+    progress.user_info = {{"username", "alice"}, {"last_learn_position", 20}};
+    progress.log_seq = 42;
+    progress.set(catalog.id_of("banana"), {3, 1, 1000});
+    progress.set(catalog.id_of("ozone layer"), {0, 2, 2000});
+
+    CHECK(file.save("alice", progress));
+    UserProgress loaded;
+    CHECK(file.load("alice", loaded));
+    CHECK_EQ(loaded.log_seq, 42u);
+    CHECK_EQ(loaded.user_info.value("last_learn_position", 0), 20);
+    CHECK_EQ(loaded.get(catalog.id_of("banana")).mistakes, 3);
+    CHECK_EQ(loaded.get(catalog.id_of("banana")).correct_count, 1);
+    CHECK_EQ(loaded.get(catalog.id_of("banana")).last_seen, 1000u);
+    CHECK_EQ(loaded.get(catalog.id_of("ozone layer")).correct_count, 2);
+    CHECK(loaded.get(catalog.id_of("apple")).is_default());
+    CHECK_EQ(loaded.get_totals().review_count, 1u);
+    CHECK_EQ(loaded.get_totals().total_mistakes, 3u);
+    CHECK_EQ(loaded.get_totals().total_correct, 3u);
+
+    // 只读 user_info 的路径与完整解码一致
+    json info;
+    CHECK(file.load_info("alice", info));
+    CHECK_EQ(info.value("log_seq", 0), 42);
+    CHECK_EQ(info.value("username", ""), "alice");
+
+    // 重新编码得到相同的字节
+    CHECK(file.encode(loaded) == file.encode(progress));
+}
+
+void test_version1_dense(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressFile file(users_dir, catalog);
+
+    // 版本1：每个单词一条 8 字节记录，按 id 排列
+    string records;
+    put_counts(records, 0, 0, 0);
+    put_counts(records, 2, 0, 500);
+    put_counts(records, 0, 0, 0);
+    put_counts(records, 1, 4, 600);
+    string bytes = encode_base_header(1, UserProgressFile::DENSE_RECORD_SIZE, catalog.fingerprint(),
+                                      WORDS.size(), R"({"username":"v1"})", 7, records);
+
+    UserProgress progress;
+    CHECK(file.decode(bytes, progress));
+    CHECK_EQ(progress.log_seq, 7u);
+    CHECK_EQ(progress.user_info.value("username", ""), "v1");
+    CHECK_EQ(progress.get(1).mistakes, 2);
+    CHECK_EQ(progress.get(1).last_seen, 500u);
+    CHECK_EQ(progress.get(3).correct_count, 4);
+    CHECK(progress.get(0).is_default());
+    CHECK_EQ(progress.get_totals().review_count, 2u);
+
+    // 稠密记录数必须等于词表大小
+    string short_bytes = encode_base_header(1, UserProgressFile::DENSE_RECORD_SIZE, catalog.fingerprint(),
+                                            WORDS.size() - 1, "{}", 0, records.substr(0, 24));
+    CHECK(!file.decode(short_bytes, progress));
+}
+
+void test_version2_sparse(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressFile file(users_dir, catalog);
+
+    // 版本2：32 字节文件头，稀疏 12 字节记录
+    string records;
+    put<uint32_t>(records, 2);
+    put_counts(records, 5, 1, 700);
+    string bytes = encode_base_header(2, UserProgressFile::RECORD_SIZE, catalog.fingerprint(), 1, "{}", 9, records);
+
+    UserProgress progress;
+    CHECK(file.decode(bytes, progress));
+    CHECK_EQ(progress.log_seq, 9u);
+    CHECK_EQ(progress.get(2).mistakes, 5);
+    CHECK_EQ(progress.get(2).correct_count, 1);
+    CHECK_EQ(progress.get_totals().total_mistakes, 5u);
+
+    // 截断的记录数组与越界的 id 都拒绝解码
+    CHECK(!file.decode(bytes.substr(0, bytes.size() - 1), progress));
+    string bad_id;
+    put<uint32_t>(bad_id, WORDS.size());
+    put_counts(bad_id, 1, 0, 0);
+    CHECK(!file.decode(encode_base_header(2, UserProgressFile::RECORD_SIZE, catalog.fingerprint(), 1, "{}", 0, bad_id),
+                       progress));
+}
+
+void test_vocabulary_remap(const string& users_dir) {
+    string old_bytes;
+    {
+        VocabularyCatalog old_catalog(WORDS);
+        UserProgressFile old_file(users_dir, old_catalog);
+        UserProgress progress(old_catalog);
+        progress.set(old_catalog.id_of("apple"), {1, 0, 100});
+        progress.set(old_catalog.id_of("cherry"), {4, 2, 300});
+        progress.set(old_catalog.id_of("ozone layer"), {2, 0, 400});
+        old_bytes = old_file.encode(progress);
+    }
+
+    // 新词表删除了 ozone layer，插入了新单词，其余单词的 id 都变了
+    VocabularyCatalog new_catalog(vector<string>{"date", "cherry", "banana", "apple"});
+    UserProgressFile new_file(users_dir, new_catalog);
+    UserProgress progress;
+    CHECK(new_file.decode(old_bytes, progress));
+    CHECK_EQ(progress.get(new_catalog.id_of("apple")).mistakes, 1);
+    CHECK_EQ(progress.get(new_catalog.id_of("cherry")).mistakes, 4);
+    CHECK_EQ(progress.get(new_catalog.id_of("cherry")).correct_count, 2);
+    CHECK(progress.get(new_catalog.id_of("date")).is_default());
+    CHECK(progress.get(new_catalog.id_of("banana")).is_default());
+    CHECK_EQ(progress.get_totals().review_count, 2u);
+    CHECK_EQ(progress.get_totals().total_mistakes, 5u);
+
+    // 没有保存过的词表无法映射
+    string unknown = old_bytes;
+    uint64_t fingerprint = 0x1234;
+    memcpy(&unknown[8], &fingerprint, sizeof(fingerprint));
+    CHECK(!new_file.decode(unknown, progress));
+}
+
+}
+
+int main() {
+    TempDir dir("user_progress_file_test");
+    test_round_trip(dir.path);
+    test_version1_dense(dir.path);
+    test_version2_sparse(dir.path);
+    test_vocabulary_remap(dir.path);
+    return test_result("UserProgressFileTest");
+}
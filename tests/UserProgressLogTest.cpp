@@ -0,0 +1,211 @@
+/**
+ * @file UserProgressLogTest.cpp
+ * @brief 进度日志重放测试：跳过已合并进快照与重复写入的记录、丢弃没有换行的残行、残行之后的追加、轮转日志的顺序
+ */
+
+#include "UserProgressLog.h"
+#include "UserProgressFile.h"
+#include "TestSupport.h"
+#include <fstream>
+
+namespace {
+
+const vector<string> WORDS = {"apple", "banana", "cherry", "ozone layer"};
+
+void write_file(const string& path, const string& content) {
+    ofstream file(path, ios::binary | ios::trunc);
+    file << content;
+}
+
+vector<UserProgressLog::Record> replay_all(const UserProgressLog& log, const string& username, uint64_t applied_seq,
+                                           uint64_t& last_seq) {
+    vector<UserProgressLog::Record> records;
+    last_seq = log.replay(username, applied_seq, [&records](const UserProgressLog::Record& record) {
+        records.push_back(record);
+    });
+    return records;
+}
+
+void test_append_and_replay(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressLog log(users_dir, catalog);
+
+    vector<UserProgressLog::Record> records(3);
+    records[0] = {1, UserProgressLog::OP_MISTAKE, catalog.id_of("ozone layer"), 2, 100};
+    records[1] = {2, UserProgressLog::OP_CORRECT, catalog.id_of("apple"), 1, 101};
+    records[2] = {3, UserProgressLog::OP_REVIEW_POSITION, VocabularyCatalog::NOT_FOUND, 40, 102};
+    CHECK(log.append("alice", records));
+
+    uint64_t last_seq = 0;
+    vector<UserProgressLog::Record> replayed = replay_all(log, "alice", 0, last_seq);
+    CHECK_EQ(last_seq, 3u);
+    CHECK_EQ(replayed.size(), 3u);
+    if (replayed.size() == 3) {
+        // 含空格的单词放在行尾，重放后仍映射到同一个 id
+        CHECK_EQ(replayed[0].word_id, catalog.id_of("ozone layer"));
+        CHECK_EQ(replayed[0].value, 2);
+        CHECK_EQ(replayed[1].op, UserProgressLog::OP_CORRECT);
+        CHECK_EQ(replayed[2].value, 40);
+    }
+}
+
+void test_skips_merged_records(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressLog log(users_dir, catalog);
+    UserProgressFile file(users_dir, catalog);
+
+    // 快照已合并到 seq 2：保存快照后、截断日志前崩溃留下的记录不能重复计数
+    UserProgress progress(catalog);
+    progress.set(catalog.id_of("banana"), {2, 0, 100});
+    progress.log_seq = 2;
+    CHECK(file.save("bob", progress));
+    write_file(log.get_log_file("bob"),
+               "1 m 1 100 banana\n"
+               "2 m 1 100 banana\n"
+               "3 m 1 101 banana\n"
+               "4 c 1 102 cherry\n");
+
+    UserProgress loaded;
+    CHECK(file.load("bob", loaded));
+    uint64_t last_seq = 0;
+    vector<UserProgressLog::Record> replayed = replay_all(log, "bob", loaded.log_seq, last_seq);
+    CHECK_EQ(last_seq, 4u);
+    CHECK_EQ(replayed.size(), 2u);
+    for (const UserProgressLog::Record& record : replayed) {
+        CHECK(record.seq > 2);
+        loaded.apply(record);
+    }
+    CHECK_EQ(loaded.get(catalog.id_of("banana")).mistakes, 3);
+    CHECK_EQ(loaded.get(catalog.id_of("cherry")).correct_count, 1);
+
+    // 全部记录都已合并时返回快照的序列号
+    replayed = replay_all(log, "bob", 4, last_seq);
+    CHECK(replayed.empty());
+    CHECK_EQ(last_seq, 4u);
+}
+
+void test_retried_append(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressLog log(users_dir, catalog);
+
+    // 第一次追加只写入了 2、3 两条就失败，重试时整批（2、3、4）再写一次
+    write_file(log.get_log_file("gina"),
+               "1 m 1 100 apple\n"
+               "2 m 1 101 banana\n"
+               "3 c 1 102 banana\n"
+               "2 m 1 101 banana\n"
+               "3 c 1 102 banana\n"
+               "4 m 1 103 cherry\n");
+    uint64_t last_seq = 0;
+    vector<UserProgressLog::Record> replayed = replay_all(log, "gina", 0, last_seq);
+    CHECK_EQ(last_seq, 4u);
+    CHECK_EQ(replayed.size(), 4u);
+    UserProgress progress(catalog);
+    for (const UserProgressLog::Record& record : replayed) {
+        progress.apply(record);
+    }
+    CHECK_EQ(progress.get(catalog.id_of("banana")).mistakes, 1);
+    CHECK_EQ(progress.get(catalog.id_of("banana")).correct_count, 1);
+
+    // 重试发生在轮转之后时，重复的记录分布在两个文件中
+    write_file(log.get_log_file("hank"), "5 m 1 105 apple\n6 m 1 106 apple\n");
+    CHECK(log.rotate("hank"));
+    write_file(log.get_log_file("hank"), "6 m 1 106 apple\n7 m 1 107 apple\n");
+    replayed = replay_all(log, "hank", 4, last_seq);
+    CHECK_EQ(last_seq, 7u);
+    CHECK_EQ(replayed.size(), 3u);
+}
+
+void test_truncated_last_line(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressLog log(users_dir, catalog);
+
+    // 崩溃留下的末行：缺少单词、缺少时间戳、只有序列号
+    const char* truncated_tails[] = {"3 m 1 103", "3 m 1", "3"};
+    for (const char* tail : truncated_tails) {
+        write_file(log.get_log_file("carol"),
+                   string("1 m 1 100 apple\n"
+                          "2 c 1 101 unknown word\n") + tail);
+        uint64_t last_seq = 0;
+        vector<UserProgressLog::Record> replayed = replay_all(log, "carol", 0, last_seq);
+        // 不在词表中的单词被跳过，但其序列号仍计入
+        CHECK_EQ(replayed.size(), 1u);
+        CHECK_EQ(last_seq, 2u);
+    }
+
+    // 没有换行的末行即使字段齐全也丢弃：单词可能被截断成另一个单词（banana -> ban）
+    write_file(log.get_log_file("carol"), "1 m 1 100 apple\n2 m 1 101 cherry");
+    uint64_t last_seq = 0;
+    vector<UserProgressLog::Record> replayed = replay_all(log, "carol", 0, last_seq);
+    CHECK_EQ(replayed.size(), 1u);
+    CHECK_EQ(last_seq, 1u);
+}
+
+void test_append_after_torn_tail(const string& users_dir) {
+    VocabularyCatalog catalog(vector<string>{"apple", "ban", "banana", "cherry"});
+    UserProgressLog log(users_dir, catalog);
+
+    // 残行 "ban" 恰好也是词表中的单词
+    write_file(log.get_log_file("erin"), "1 m 1 100 apple\n2 m 1 101 ban");
+    vector<UserProgressLog::Record> records(1);
+    records[0] = {3, UserProgressLog::OP_CORRECT, catalog.id_of("cherry"), 1, 200};
+    CHECK(log.append("erin", records));
+
+    uint64_t last_seq = 0;
+    vector<UserProgressLog::Record> replayed = replay_all(log, "erin", 0, last_seq);
+    CHECK_EQ(last_seq, 3u);
+    CHECK_EQ(replayed.size(), 2u);
+    if (replayed.size() == 2) {
+        CHECK_EQ(replayed[0].seq, 1u);
+        CHECK_EQ(replayed[1].seq, 3u);
+        CHECK_EQ(replayed[1].word_id, catalog.id_of("cherry"));
+    }
+
+    // 残行已从文件中截掉，新记录另起一行
+    ifstream file(log.get_log_file("erin"), ios::binary);
+    string content((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    CHECK_EQ(content, "1 m 1 100 apple\n3 c 1 200 cherry\n");
+
+    // 整个文件只有一条残行时截为空
+    write_file(log.get_log_file("frank"), "1 m 1 100 app");
+    records[0] = {2, UserProgressLog::OP_MISTAKE, catalog.id_of("apple"), 1, 201};
+    CHECK(log.append("frank", records));
+    replayed = replay_all(log, "frank", 0, last_seq);
+    CHECK_EQ(replayed.size(), 1u);
+    CHECK_EQ(last_seq, 2u);
+}
+
+void test_compacting_log_first(const string& users_dir) {
+    VocabularyCatalog catalog(WORDS);
+    UserProgressLog log(users_dir, catalog);
+
+    write_file(log.get_log_file("dave"), "5 l 60 105 -\n");
+    CHECK(log.rotate("dave"));
+    write_file(log.get_log_file("dave"), "6 l 80 106 -\n");
+
+    uint64_t last_seq = 0;
+    vector<UserProgressLog::Record> replayed = replay_all(log, "dave", 4, last_seq);
+    CHECK_EQ(last_seq, 6u);
+    CHECK_EQ(replayed.size(), 2u);
+    if (replayed.size() == 2) {
+        CHECK_EQ(replayed[0].seq, 5u);
+        CHECK_EQ(replayed[1].value, 80);
+    }
+
+    CHECK(log.truncate("dave"));
+    replayed = replay_all(log, "dave", 6, last_seq);
+    CHECK(replayed.empty());
+}
+
+}
+
+int main() {
+    TempDir dir("user_progress_log_test");
+    test_append_and_replay(dir.path);
+    test_skips_merged_records(dir.path);
+    test_retried_append(dir.path);
+    test_truncated_last_line(dir.path);
+    test_append_after_torn_tail(dir.path);
+    test_compacting_log_first(dir.path);
+    return test_result("UserProgressLogTest");
+}
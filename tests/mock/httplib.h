@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <ctime>
+
+/**
+ * @brief 测试用的 httplib 替身，只实现 DictionaryClient 用到的接口
+ *
+ * 不建立网络连接：Get 模拟 mock::request_ms 的上游耗时，记录同时进行的请求数，
+ * 路径含 "fail" 时返回连接错误，含 "status500" 时返回 500。
+ * 响应体为 "<连接序号> <路径>"，测试据此判断连接是否被复用。
+ * 与真实 httplib 一样，未定义 CPPHTTPLIB_OPENSSL_SUPPORT 时 https 地址无效。
+ */
+namespace httplib {
+
+namespace mock {
+inline std::atomic<int> request_ms{0};      ///< 每个请求的模拟耗时
+inline std::atomic<int> in_flight{0};       ///< 正在进行的请求数
+inline std::atomic<int> peak_in_flight{0};  ///< 同时进行的请求数峰值
+inline std::atomic<int> clients_created{0}; ///< 已创建的连接数
+
+inline void reset() {
+    request_ms = 0;
+    in_flight = 0;
+    peak_in_flight = 0;
+    clients_created = 0;
+}
+}
+
+using Headers = std::multimap<std::string, std::string>;
+
+enum class Error {
+    Success = 0,
+    Connection
+};
+
+inline std::string to_string(Error error) {
+    return error == Error::Success ? "Success" : "Connection";
+}
+
+struct Response {
+    int status = 200;
+    std::string body;
+};
+
+class Result {
+public:
+    Result(std::unique_ptr<Response> response, Error error) : response(std::move(response)), error_code(error) {}
+
+    explicit operator bool() const { return response != nullptr; }
+    const Response* operator->() const { return response.get(); }
+    Error error() const { return error_code; }
+
+private:
+    std::unique_ptr<Response> response;
+    Error error_code;
+};
+
+class Client {
+public:
+    explicit Client(const std::string& url) : url(url), id(++mock::clients_created) {}
+
+    bool is_valid() const {
+#ifdef CPPHTTPLIB_OPENSSL_SUPPORT
+        return url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0;
+#else
+        return url.rfind("http://", 0) == 0;
+#endif
+    }
+
+    void set_keep_alive(bool) {}
+    void set_follow_location(bool) {}
+    void set_connection_timeout(time_t, time_t = 0) {}
+    void set_read_timeout(time_t, time_t = 0) {}
+    void set_write_timeout(time_t, time_t = 0) {}
+    void set_default_headers(Headers) {}
+
+    Result Get(const std::string& path) {
+        int current = ++mock::in_flight;
+        int peak = mock::peak_in_flight;
+        while (current > peak && !mock::peak_in_flight.compare_exchange_weak(peak, current)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(mock::request_ms.load()));
+        mock::in_flight--;
+
+        if (path.find("fail") != std::string::npos) {
+            return Result(nullptr, Error::Connection);
+        }
+        auto response = std::make_unique<Response>();
+        response->status = path.find("status500") != std::string::npos ? 500 : 200;
+        response->body = std::to_string(id) + " " + path;
+        return Result(std::move(response), Error::Success);
+    }
+
+private:
+    std::string url;
+    int id;
+};
+
+}
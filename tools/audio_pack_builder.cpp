@@ -0,0 +1,198 @@
+/**
+ * @file audio_pack_builder.cpp
+ * @brief 音频包生成工具：把词表中每个单词预先合成为 WAV，打包为服务器可直接映射的单个文件
+ *
+ * 用法：
+ *   audio_pack_builder [--jobs N] [--speed S] [words.txt] [words.pack]
+ *
+ * espeak-ng 的合成状态是进程级的，同一进程内无法并行合成，因此按核数 fork 子进程，
+ * 第 k 个子进程合成第 k、k+N、k+2N... 个单词，结果写入各自的临时文件，
+ * 父进程等待全部结束后按词表顺序组装音频包。
+ */
+
+#include "VocabularyCatalog.h"
+#include "SpeechEngine.h"
+#include "AudioPack.h"
+#include "FileUtils.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+static void print_usage(const char* program) {
+    cerr << "Usage:" << endl;
+    cerr << "  " << program << " [--jobs N] [--speed S] [words.txt] [words.pack]" << endl;
+}
+
+/**
+ * @brief 子进程：合成分给自己的单词并写入临时文件
+ *
+ * 文件格式：u32 采样率，随后每个单词一条 [u32 序号][u32 长度][WAV]。合成失败的单词不写入。
+ */
+static int render_part(const vector<string>& words, size_t first, size_t step, int speed, const string& part_file) {
+    SpeechEngine& engine = SpeechEngine::instance();
+    if (!engine.available()) {
+        cerr << "Error: No TTS engine available" << endl;
+        return 1;
+    }
+
+    ofstream out(part_file, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cerr << "Error: Cannot write " << part_file << endl;
+        return 1;
+    }
+    uint32_t rate = engine.sample_rate();
+    out.write(reinterpret_cast<const char*>(&rate), sizeof(rate));
+
+    for (size_t i = first; i < words.size(); i += step) {
+        vector<int16_t> samples;
+        if (!engine.synthesize(words[i], speed, samples)) {
+            cerr << "Warning: Cannot synthesize " << words[i] << endl;
+            continue;
+        }
+        string wav = SpeechEngine::encode_wav(samples, engine.sample_rate());
+        uint32_t index = i;
+        uint32_t size = wav.size();
+        out.write(reinterpret_cast<const char*>(&index), sizeof(index));
+        out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.write(wav.data(), wav.size());
+    }
+    out.close();
+    return out ? 0 : 1;
+}
+
+/**
+ * @brief 父进程：读取一个子进程的结果
+ */
+static bool read_part(const string& part_file, vector<string>& clips, uint32_t& sample_rate) {
+    ifstream in(part_file, ios::binary);
+    uint32_t rate = 0;
+    if (!in.read(reinterpret_cast<char*>(&rate), sizeof(rate))) {
+        return false;
+    }
+    if (sample_rate != 0 && rate != sample_rate) {
+        cerr << "Error: Workers produced different sample rates" << endl;
+        return false;
+    }
+    sample_rate = rate;
+
+    uint32_t index, size;
+    while (in.read(reinterpret_cast<char*>(&index), sizeof(index))) {
+        if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)) || index >= clips.size()) {
+            return false;
+        }
+        clips[index].resize(size);
+        if (!in.read(&clips[index][0], size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned cores = thread::hardware_concurrency();
+    size_t jobs = cores > 0 ? cores : 1;
+    int speed = 150;
+    vector<string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if ((arg == "--jobs" || arg == "-j") && i + 1 < argc) {
+                jobs = stoul(argv[++i]);
+            } else if ((arg == "--speed" || arg == "-s") && i + 1 < argc) {
+                speed = stoi(argv[++i]);
+            } else if (arg.rfind("-", 0) == 0) {
+                print_usage(argv[0]);
+                return 1;
+            } else {
+                paths.push_back(arg);
+            }
+        } catch (const exception&) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (jobs == 0 || speed <= 0 || paths.size() > 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    string words_file = paths.size() > 0 ? paths[0] : "data/words.txt";
+    string pack_file = paths.size() > 1 ? paths[1] : "data/words.pack";
+
+    VocabularyCatalog catalog(words_file);
+    const vector<string>& words = catalog.words();
+    if (words.empty()) {
+        cerr << "Error: Cannot read vocabulary " << words_file << endl;
+        return 1;
+    }
+    jobs = min(jobs, words.size());
+
+    auto started = chrono::steady_clock::now();
+    vector<pid_t> workers;
+    vector<string> part_files;
+    for (size_t k = 0; k < jobs; k++) {
+        string part_file = pack_file + ".part" + to_string(k);
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            break;
+        }
+        if (pid == 0) {
+            // 子进程不执行父进程的析构与缓冲刷新
+            _exit(render_part(words, k, jobs, speed, part_file));
+        }
+        workers.push_back(pid);
+        part_files.push_back(part_file);
+    }
+
+    bool ok = workers.size() == jobs;
+    for (pid_t pid : workers) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+        }
+    }
+
+    vector<string> clips(words.size());
+    uint32_t sample_rate = 0;
+    for (const string& part_file : part_files) {
+        if (ok && !read_part(part_file, clips, sample_rate)) {
+            cerr << "Error: Cannot read worker output " << part_file << endl;
+            ok = false;
+        }
+        remove(part_file.c_str());
+    }
+    if (!ok) {
+        cerr << "Error: Audio pack workers failed" << endl;
+        return 1;
+    }
+
+    size_t missing = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+        if (clips[i].empty()) {
+            missing++;
+        }
+    }
+    if (missing > 0) {
+        cerr << "Error: " << missing << " words could not be synthesized" << endl;
+        return 1;
+    }
+
+    string pack = AudioPack::encode(words, clips, sample_rate);
+    if (!FileUtils::write_text_file_atomic(pack_file, pack)) {
+        cerr << "Error: Cannot write " << pack_file << endl;
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cout << "Wrote " << words.size() << " words (" << pack.size() / 1024 << " KB) to " << pack_file
+         << " with " << jobs << " workers in " << seconds << "s" << endl;
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file dictionary_stub_server.cpp
+ * @brief 本地词典桩服务：返回固定格式的词典响应，用于在不访问外网的情况下测试在线查词
+ *
+ * 用法：
+ *   dictionary_stub_server [--port N] [--delay-ms MS]
+ *
+ * 响应与 WordApp::convert_iciba_response 解析的格式相同，可模拟上游延迟。
+ * 配合 word_app --dictionary-url http://127.0.0.1:N 使用，查询耗时应接近 delay-ms。
+ */
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+using json = nlohmann::json;
+using namespace std;
+
+static void print_usage(const char* program) {
+    cerr << "Usage:" << endl;
+    cerr << "  " << program << " [--port N] [--delay-ms MS]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int port = 9000;
+    int delay_ms = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg == "--port" && i + 1 < argc) {
+                port = stoi(argv[++i]);
+            } else if (arg == "--delay-ms" && i + 1 < argc) {
+                delay_ms = stoi(argv[++i]);
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const exception&) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    httplib::Server server;
+    atomic<uint64_t> requests{0};
+
+    server.Get("/openapi.do", [&](const httplib::Request& req, httplib::Response& res) {
+        requests++;
+        if (delay_ms > 0) {
+            this_thread::sleep_for(chrono::milliseconds(delay_ms));
+        }
+        string word = req.get_param_value("q");
+        json response = {
+            {"word_name", word},
+            {"symbols", json::array({{
+                {"ph_en", word},
+                {"ph_am", word},
+                {"parts", json::array({{
+                    {"part", "n."},
+                    {"means", json::array({"stub meaning of " + word})}
+                }})}
+            }})}
+        };
+        res.set_content(response.dump(), "application/json");
+    });
+
+    server.Get("/stats", [&](const httplib::Request&, httplib::Response& res) {
+        res.set_content(json{{"requests", requests.load()}}.dump(), "application/json");
+    });
+
+    cout << "Dictionary stub listening on http://127.0.0.1:" << port << " (delay " << delay_ms << " ms)" << endl;
+    if (!server.listen("127.0.0.1", port)) {
+        cerr << "Error: Cannot listen on port " << port << endl;
+        return 1;
+    }
+    return 0;
+}
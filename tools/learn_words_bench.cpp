@@ -0,0 +1,120 @@
+/**
+ * @file learn_words_bench.cpp
+ * @brief /get_learn_words 处理函数的延迟基准测试
+ *
+ * 用法：
+ *   learn_words_bench [--user NAME] [--requests N] [--threads N]
+ *
+ * 在当前目录的 data/ 上登录指定用户，按 HttpServer 中 /get_learn_words 的处理顺序
+ * 计时：按令牌取用户上下文、WordApp::get_learn_words、序列化响应。不包含 httplib 的
+ * 请求解析与套接字收发。会追加学习位置记录，请在数据目录的副本中运行。
+ *   repeat  每个线程反复请求第 1 页
+ *   pages   每个线程依次翻页，到最后一页后从头开始
+ * 设置 USER_EXECUTION_MODE=actor 时测量 actor 模式。
+ */
+
+#include "WordApp.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+
+using namespace std;
+
+static void print_usage(const char* program) {
+    cerr << "Usage:" << endl;
+    cerr << "  " << program << " [--user NAME] [--requests N] [--threads N]" << endl;
+}
+
+/**
+ * @brief 运行一个场景并输出单次请求耗时的分位数
+ */
+static void run_scenario(const string& name, WordApp& app, const string& token, size_t requests,
+                         size_t threads, bool paging) {
+    vector<double> latencies;
+    latencies.reserve(requests * threads);
+    mutex latencies_mutex;
+
+    auto started = chrono::steady_clock::now();
+    vector<thread> clients;
+    for (size_t t = 0; t < threads; t++) {
+        clients.emplace_back([&] {
+            vector<double> local;
+            local.reserve(requests);
+            int page = 1;
+            for (size_t i = 0; i < requests; i++) {
+                auto begin = chrono::steady_clock::now();
+                shared_ptr<UserContext> context = app.get_user_context(token);
+                json result = app.get_learn_words(*context, page);
+                string body = result.dump();
+                local.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count());
+                if (paging) {
+                    page = page < result.value("totalPages", 1) ? page + 1 : 1;
+                }
+            }
+            lock_guard<mutex> lock(latencies_mutex);
+            latencies.insert(latencies.end(), local.begin(), local.end());
+        });
+    }
+    for (thread& client : clients) {
+        client.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, (size_t)(p * latencies.size()))];
+    };
+    cout << left << setw(8) << name << right << fixed << setprecision(1)
+         << setw(10) << percentile(0.5) << setw(10) << percentile(0.99)
+         << setw(10) << percentile(0.999) << setw(12) << (latencies.empty() ? 0.0 : latencies.back())
+         << setw(12) << setprecision(0) << latencies.size() / seconds << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string username = "tzz";
+    size_t requests = 20000;
+    size_t threads = 1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg == "--user" && i + 1 < argc) {
+                username = argv[++i];
+            } else if (arg == "--requests" && i + 1 < argc) {
+                requests = stoul(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                threads = stoul(argv[++i]);
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const exception&) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (requests == 0 || threads == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    WordApp app;
+    json login = app.login_user(username);
+    if (!login.value("success", false)) {
+        cerr << "Error: Cannot log in as " << username << ": " << login.value("error", "") << endl;
+        return 1;
+    }
+    string token = login["session_token"].get<string>();
+
+    cout << "user " << username << ", threads " << threads << ", requests " << requests << " per thread" << endl;
+    cout << left << setw(8) << "case" << right << setw(10) << "p50 us" << setw(10) << "p99 us"
+         << setw(10) << "p99.9 us" << setw(12) << "max us" << setw(12) << "req/s" << endl;
+    run_scenario("repeat", app, token, requests, threads, false);
+    run_scenario("pages", app, token, requests, threads, true);
+    app.shutdown();
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file progress_kernels_bench.cpp
+ * @brief 进度聚合内核的微基准测试
+ *
+ * 用法：
+ *   progress_kernels_bench [iterations]
+ *
+ * 分别在 5k、100k、1M 单词的随机进度数组上运行标量、SSE2、AVX2 实现，
+ * 校验结果一致并输出每次聚合的耗时。
+ */
+
+#include "ProgressKernels.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+struct Kernel {
+    const char* name;
+    ProgressKernels::AggregateFunction function;
+    bool supported;
+};
+
+static void fill_progress(vector<uint16_t>& mistakes, vector<uint16_t>& correct, size_t count) {
+    // 模拟真实分布：大部分单词未出错，少数单词错误次数较多
+    mt19937 generator(42);
+    uniform_int_distribution<int> percent(0, 99);
+    uniform_int_distribution<int> small(1, 5);
+    uniform_int_distribution<int> large(0, 65535);
+
+    mistakes.resize(count);
+    correct.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        int roll = percent(generator);
+        mistakes[i] = roll < 70 ? 0 : (roll < 99 ? small(generator) : large(generator));
+        correct[i] = percent(generator) < 50 ? 0 : small(generator);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? stoi(argv[1]) : 200;
+    vector<Kernel> kernels = {
+        {"scalar", ProgressKernels::aggregate_scalar, true},
+        {"sse2", ProgressKernels::aggregate_sse2, ProgressKernels::has_sse2()},
+        {"avx2", ProgressKernels::aggregate_avx2, ProgressKernels::has_avx2()}
+    };
+
+    cout << "aggregate() uses: " << ProgressKernels::implementation() << endl;
+    cout << left << setw(10) << "words" << setw(10) << "kernel"
+         << setw(14) << "us/call" << setw(14) << "ns/word" << "GB/s" << endl;
+
+    int status = 0;
+    for (size_t count : {(size_t)5000, (size_t)100000, (size_t)1000000}) {
+        vector<uint16_t> mistakes;
+        vector<uint16_t> correct;
+        fill_progress(mistakes, correct, count);
+        ProgressTotals expected = ProgressKernels::aggregate_scalar(mistakes.data(), correct.data(), count);
+
+        for (const Kernel& kernel : kernels) {
+            if (!kernel.supported) {
+                cout << left << setw(10) << count << setw(10) << kernel.name << "unsupported" << endl;
+                continue;
+            }
+
+            ProgressTotals totals = kernel.function(mistakes.data(), correct.data(), count);
+            if (!(totals == expected)) {
+                cerr << "Mismatch: " << kernel.name << " on " << count << " words" << endl;
+                status = 1;
+            }
+
+            auto start = chrono::steady_clock::now();
+            uint64_t sink = 0;
+            for (int i = 0; i < iterations; i++) {
+                sink += kernel.function(mistakes.data(), correct.data(), count).review_count;
+            }
+            auto elapsed = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            double per_call = elapsed / iterations;
+            if (sink == 1) cout << "";   // 防止循环被优化掉
+
+            cout << left << setw(10) << count << setw(10) << kernel.name
+                 << setw(14) << fixed << setprecision(2) << per_call / 1000
+                 << setw(14) << per_call / count
+                 << count * 2 * sizeof(uint16_t) / per_call << endl;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file task_queue_bench.cpp
+ * @brief HTTP 任务队列的排队延迟基准测试
+ *
+ * 用法：
+ *   task_queue_bench [--workers N] [--tasks N] [--rate N]
+ *
+ * 与 httplib 的监听线程一样，由单个线程放入任务，统计每个任务从放入到开始执行的
+ * 排队时间（p50/p99/p99.9/最大值）：
+ *   burst  一次放入全部任务，每个任务约 20 微秒
+ *   paced  按每秒 rate 个的速度放入，每个任务约 50 微秒
+ *   mixed  按 paced 的速度放入，另有 workers 个持续 200 毫秒的慢任务处于 BlockingScope 中
+ */
+
+#include "WorkStealingTaskQueue.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+
+using namespace std;
+
+static void print_usage(const char* program) {
+    cerr << "Usage:" << endl;
+    cerr << "  " << program << " [--workers N] [--tasks N] [--rate N]" << endl;
+}
+
+static void spin_for(chrono::microseconds duration) {
+    auto until = chrono::steady_clock::now() + duration;
+    while (chrono::steady_clock::now() < until) {
+    }
+}
+
+/**
+ * @brief 运行一个场景并输出排队时间分位数
+ */
+static void run_scenario(const string& name, size_t workers, size_t tasks, size_t rate,
+                         chrono::microseconds work, size_t slow_tasks) {
+    vector<double> waits;
+    waits.reserve(tasks);
+    mutex waits_mutex;
+
+    auto started = chrono::steady_clock::now();
+    {
+        WorkStealingTaskQueue queue(workers, 0, slow_tasks);
+        for (size_t i = 0; i < slow_tasks; i++) {
+            queue.enqueue([] {
+                WorkStealingTaskQueue::BlockingScope blocking;
+                this_thread::sleep_for(chrono::milliseconds(200));
+            });
+        }
+
+        auto next = chrono::steady_clock::now();
+        auto interval = rate > 0 ? chrono::nanoseconds(1000000000 / rate) : chrono::nanoseconds(0);
+        for (size_t i = 0; i < tasks; i++) {
+            if (rate > 0) {
+                // 睡眠而不是忙等，单核机器上放入线程才不会抢走工作线程的 CPU
+                next += interval;
+                this_thread::sleep_until(next);
+            }
+            auto enqueued = chrono::steady_clock::now();
+            queue.enqueue([&waits, &waits_mutex, enqueued, work] {
+                double wait_us = chrono::duration<double, micro>(chrono::steady_clock::now() - enqueued).count();
+                spin_for(work);
+                lock_guard<mutex> lock(waits_mutex);
+                waits.push_back(wait_us);
+            });
+        }
+        queue.shutdown();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    sort(waits.begin(), waits.end());
+    auto percentile = [&waits](double p) {
+        return waits.empty() ? 0.0 : waits[min(waits.size() - 1, (size_t)(p * waits.size()))];
+    };
+    cout << left << setw(8) << name << right << fixed << setprecision(1)
+         << setw(10) << percentile(0.5) << setw(10) << percentile(0.99)
+         << setw(10) << percentile(0.999) << setw(12) << (waits.empty() ? 0.0 : waits.back())
+         << setw(12) << setprecision(0) << tasks / seconds << endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t workers = max(1u, thread::hardware_concurrency());
+    size_t tasks = 100000;
+    size_t rate = 20000;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        try {
+            if (arg == "--workers" && i + 1 < argc) {
+                workers = stoul(argv[++i]);
+            } else if (arg == "--tasks" && i + 1 < argc) {
+                tasks = stoul(argv[++i]);
+            } else if (arg == "--rate" && i + 1 < argc) {
+                rate = stoul(argv[++i]);
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const exception&) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (workers == 0 || tasks == 0 || rate == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    cout << "workers " << workers << ", tasks " << tasks << ", paced rate " << rate << "/s" << endl;
+    cout << left << setw(8) << "case" << right << setw(10) << "p50 us" << setw(10) << "p99 us"
+         << setw(10) << "p99.9 us" << setw(12) << "max us" << setw(12) << "tasks/s" << endl;
+    run_scenario("burst", workers, tasks, 0, chrono::microseconds(20), 0);
+    run_scenario("paced", workers, tasks, rate, chrono::microseconds(50), 0);
+    run_scenario("mixed", workers, tasks, rate, chrono::microseconds(50), workers);
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file user_data_tool.cpp
+ * @brief 用户数据调试工具：二进制 .dat 与 JSON 互相转换
+ *
+ * 用法：
+ *   user_data_tool export <user.dat> [words.txt]            输出 JSON 到标准输出（只含学习过的单词）
+ *   user_data_tool import <user.json> <user.dat> [words.txt] 从 JSON 生成 .dat
+ */
+
+#include "VocabularyCatalog.h"
+#include "UserProgressFile.h"
+#include "FileUtils.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static void print_usage(const char* program) {
+    cerr << "Usage:" << endl;
+    cerr << "  " << program << " export <user.dat> [words.txt]" << endl;
+    cerr << "  " << program << " import <user.json> <user.dat> [words.txt]" << endl;
+}
+
+static string users_dir_of(const string& data_file) {
+    fs::path dir = fs::path(data_file).parent_path();
+    return dir.empty() ? "./" : dir.string() + "/";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    string command = argv[1];
+    if (command == "export") {
+        string words_file = argc > 3 ? argv[3] : "data/words.txt";
+        VocabularyCatalog catalog(words_file);
+        UserProgressFile progress_file(users_dir_of(argv[2]), catalog);
+
+        ifstream file(argv[2], ios::binary);
+        if (!file.is_open()) {
+            cerr << "Error: Cannot open " << argv[2] << endl;
+            return 1;
+        }
+        string bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+        UserProgress progress;
+        if (!progress_file.decode(bytes, progress)) {
+            cerr << "Error: Cannot decode " << argv[2] << endl;
+            return 1;
+        }
+        cout << progress.to_json(catalog).dump(4) << endl;
+        return 0;
+    }
+
+    if (command == "import" && argc >= 4) {
+        string words_file = argc > 4 ? argv[4] : "data/words.txt";
+        VocabularyCatalog catalog(words_file);
+        if (catalog.size() == 0) {
+            cerr << "Error: Cannot read vocabulary " << words_file << endl;
+            return 1;
+        }
+        UserProgressFile progress_file(users_dir_of(argv[3]), catalog);
+
+        json user_data;
+        try {
+            ifstream file(argv[2]);
+            file >> user_data;
+        } catch (const exception& e) {
+            cerr << "Error: Cannot parse " << argv[2] << ": " << e.what() << endl;
+            return 1;
+        }
+
+        UserProgress progress = UserProgress::from_json(user_data, catalog);
+        if (!FileUtils::write_text_file_atomic(argv[3], progress_file.encode(progress))) {
+            cerr << "Error: Cannot write " << argv[3] << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    print_usage(argv[0]);
+    return 1;
+}